@@ -1,13 +1,15 @@
 TEMPLATE        = subdirs
-SUBDIRS         = lib quick rot unit figma
+SUBDIRS         = lib quick rot unit figma bench
 
 lib.file        = lib/Axqlib.pro
 quick.file      = test/quick/QuickTest/QuickTest.pro
 rot.file        = test/cpp/Rot13/Rot13.pro
 unit.file       = test/cpp/unit/unit.pro
 figma.file      = test/cpp/Figma/Figma.pro
+bench.file      = test/cpp/bench/bench.pro
 
 rot.depends    = lib
 quick.depends  = lib
 unit.depends   = lib
+bench.depends  = lib
 
@@ -4,9 +4,20 @@
 #include <memory>
 #include <functional>
 #include <tuple>
+#include <typeinfo>
+#include <vector>
+#include <limits>
+#include <iterator>
+#include <algorithm>
 
 #include <QIODevice>
 #include <QVariant>
+#include <QVector>
+#include <QByteArrayList>
+
+#include "axq_callable.h"
+
+class QFile;
 
 /**
  *  Axq
@@ -228,6 +239,97 @@ T get(const ParamList& list) {
     return v;
 }
 
+/**
+ * @class Lines
+ * A batch of lines output by `lines`. The lines are views to a single shared block of data,
+ * thus splitting a block does not allocate per line. A line does not include its newline.
+ *
+ */
+class AXQSHAREDLIB_EXPORT Lines {
+public:
+    Lines() {}
+    Lines(const QByteArray& block, const QVector<int>& ends) : m_block(block), m_ends(ends) {}
+    /**
+     * @function count
+     * @return number of lines
+     */
+    int count() const {return m_ends.size();}
+    /**
+     * @function at
+     * @param index of line
+     * @return a line, valid as long as the Lines object exists, take a deep copy to keep it longer.
+     */
+    QByteArray at(int index) const {
+        const int begin = index > 0 ? m_ends.at(index - 1) + 1 : 0;
+        return QByteArray::fromRawData(m_block.constData() + begin, m_ends.at(index) - begin);
+    }
+    /**
+     * @function toList
+     * @return all lines
+     */
+    QByteArrayList toList() const;
+private:
+    QByteArray m_block;
+    QVector<int> m_ends; //index of each line end (newline) in block
+};
+
+/// @cond
+template <int I, int N>
+struct _TupleList {
+    template <typename Tup> static void to(QVariantList& list, const Tup& tup) {
+        list.append(QVariant::fromValue(std::get<I>(tup)));
+        _TupleList < I + 1, N >::to(list, tup);
+    }
+    template <typename Tup> static void from(const QVariantList& list, Tup& tup) {
+        if(I < list.size()) {
+            std::get<I>(tup) = list.at(I).value<typename std::tuple_element<I, Tup>::type>();
+        }
+        _TupleList < I + 1, N >::from(list, tup);
+    }
+};
+
+template <int N>
+struct _TupleList<N, N> {
+    template <typename Tup> static void to(QVariantList&, const Tup&) {}
+    template <typename Tup> static void from(const QVariantList&, Tup&) {}
+};
+/// @endcond
+
+/**
+ * @class Tuple
+ * A std::tuple as a single Stream value. Operators typed as std::tuple<...> read it as is,
+ * thus the values are not converted to and from QVariant as with ParamList. A Tuple
+ * converts to QVariantList, and a ParamList can be read as std::tuple. When encoded, e.g. by
+ * `buffer` spill, `toLocalSocket` or `journal`, a Tuple is read back as QVariantList.
+ *
+ */
+class Tuple {
+public:
+    Tuple() {}
+    template <typename ...Args>
+    Tuple(const std::tuple<Args...>& tuple) : m_data(std::make_shared<const std::tuple<Args...>>(tuple)),
+        m_type(&typeid(std::tuple<Args...>)), m_toList(&toList<std::tuple<Args...>>) {}
+    template <typename ...Args>
+    const std::tuple<Args...>* as() const {
+        return m_type && *m_type == typeid(std::tuple<Args...>) ? static_cast<const std::tuple<Args...>*>(m_data.get()) : nullptr;
+    }
+    QVariantList toList() const {
+        return m_toList ? m_toList(m_data.get()) : QVariantList();
+    }
+private:
+    template <typename Tup>
+    static QVariantList toList(const void* data) {
+        QVariantList list;
+        list.reserve(std::tuple_size<Tup>::value);
+        _TupleList<0, std::tuple_size<Tup>::value>::to(list, *static_cast<const Tup*>(data));
+        return list;
+    }
+private:
+    std::shared_ptr<const void> m_data;
+    const std::type_info* m_type = nullptr;
+    QVariantList (*m_toList)(const void*) = nullptr;
+};
+
 /**
  *  @class Stream
  *
@@ -303,8 +405,9 @@ public:
      *
      */
     Stream each(std::function<void (const T&)> onEach) {
-        return createEach([onEach](const QVariant & v) {
-            onEach(convert<T>(v));
+        Converter<T> in;
+        return createEach([onEach, in](const QVariant & v) mutable {
+            onEach(in(v));
         });
     }
 
@@ -320,8 +423,9 @@ public:
      *
      */
     Stream map(std::function< O(const I&) > onMap) {
-        return createMap([onMap](const QVariant & v)->QVariant{
-            return convertFrom<O>(onMap(convert<I>(v)));
+        Converter<I> in;
+        return createMap([onMap, in](const QVariant & v) mutable -> QVariant{
+            return convertFrom<O>(onMap(in(v)));
         });
     }
 
@@ -394,8 +498,9 @@ public:
      *
      */
     Stream filter(std::function<bool (const T&)> onFilter) {
-        return createFilter([onFilter](const QVariant & v) {
-            return onFilter(convert<T>(v));
+        Converter<T> in;
+        return createFilter([onFilter, in](const QVariant & v) mutable {
+            return onFilter(in(v));
         });
     }
 
@@ -412,8 +517,9 @@ public:
      *
      */
     Stream waitComplete(std::function<Stream(const T&)> onWait) {
-        return createSpawn([onWait](const QVariant & v) {
-            return onWait(convert<T>(v));
+        Converter<T> in;
+        return createSpawn([onWait, in](const QVariant & v) mutable {
+            return onWait(in(v));
         });
     }
 
@@ -428,8 +534,9 @@ public:
      *
      */
     Stream completeEach(std::function<bool (const T&)> onPass) {
-        return createCompleteFilter([onPass](const QVariant & v) {
-            return onPass(convert<T>(v));
+        Converter<T> in;
+        return createCompleteFilter([onPass, in](const QVariant & v) mutable {
+            return onPass(in(v));
         });
         return *this;
     }
@@ -450,6 +557,184 @@ public:
      */
     void complete();
 
+    /**
+     * @function limit
+     * @param count number of inputs
+     * @return Stream
+     *
+     * Outputs a given number of inputs and then completes the Stream. The producer is
+     * stopped as soon as the count is reached and inputs still on their way are dropped.
+     *
+     */
+    Stream limit(int count);
+
+    template <typename T>
+    /**
+     * @function takeWhile
+     * @templateparam type
+     * @param onTake function, F(value)->boolean
+     * @return Stream
+     *
+     * Outputs inputs as long as a given function returns true, on first false the Stream
+     * is completed as `take` does.
+     *
+     */
+    Stream takeWhile(std::function<bool (const T&)> onTake) {
+        Converter<T> in;
+        return createTake(std::numeric_limits<int>::max(), [onTake, in](const QVariant & v) mutable {
+            return onTake(in(v));
+        });
+    }
+
+    /**
+     * @function skip
+     * @param count number of inputs
+     * @return Stream
+     *
+     * Ignores a given number of inputs and then outputs the rest.
+     *
+     */
+    Stream skip(int count);
+
+    template <typename T>
+    /**
+     * @function skipWhile
+     * @templateparam type
+     * @param onSkip function, F(value)->boolean
+     * @return Stream
+     *
+     * Ignores inputs as long as a given function returns true and then outputs the rest.
+     *
+     */
+    Stream skipWhile(std::function<bool (const T&)> onSkip) {
+        Converter<T> in;
+        return createSkip(0, [onSkip, in](const QVariant & v) mutable {
+            return onSkip(in(v));
+        });
+    }
+
+    /**
+     * @function first
+     * @return Stream
+     *
+     * Outputs the first input and completes the Stream, same as `take(1)`.
+     *
+     */
+    Stream first();
+
+    /**
+     * @function last
+     * @return Stream
+     *
+     * Outputs only the last input, when the Stream completes.
+     *
+     */
+    Stream last();
+
+    /**
+     * @function writeTo
+     * @param QIODevice* to write, if the device is not having a parent, the Stream will take it.
+     * @param bufferSize bytes collected before written
+     * @param flushMs maximum time in milliseconds data is kept in buffer
+     * @param maxPending bytes waiting in device (see QIODevice::bytesToWrite) until the producer is deferred, 0 for no limit
+     * @return Stream
+     *
+     * Writes inputs as QByteArray to a device and outputs them as is. Inputs are collected into
+     * a buffer and written when it is full, when `flushMs` has elapsed or when the Stream completes,
+     * thus each input does not cause a write. If the device is not open, it is opened for writing.
+     * Sequential devices, like sockets, defer the producer when more than `maxPending` bytes are
+     * not yet written and the Stream is completed only after all is written.
+     *
+     */
+    Stream writeTo(QIODevice* device, int bufferSize = 0x10000, int flushMs = 100, qint64 maxPending = 0x100000);
+
+    /**
+     * @function toLocalSocket
+     * @param name of local server, see QLocalServer
+     * @param window number of outputs sent ahead before the producer is deferred until the receiver has acknowledged them
+     * @return Stream
+     *
+     * Sends inputs, errors and completion to a Stream created with `fromLocalSocket` using the same name,
+     * possibly in another process, and outputs the inputs as is. If the receiving end is not yet listening,
+     * connection is retried. The Stream is completed when the receiver has completed.
+     * Values are serialized with QDataStream, so custom types need registered stream operators.
+     *
+     */
+    Stream toLocalSocket(const QString& name, int window = 64);
+
+    /**
+     * @function journal
+     * @param path base name of journal files
+     * @param syncMs maximum time in milliseconds written data is not yet synced to disk, 0 syncs each input
+     * @param segmentSize bytes in a file before the next one is started
+     * @return Stream
+     *
+     * Appends inputs to a journal and outputs them as is. Journal is a set of `path.<number>.log` files,
+     * named by the number of their first record, and their `.idx` files that let `replay` seek quickly.
+     * Values are serialized with Codec. If a journal exists, appending continues after its last complete
+     * record, thus a torn record left by a crash is dropped.
+     *
+     */
+    Stream journal(const QString& path, int syncMs = 1000, qint64 segmentSize = 0x4000000);
+
+    /**
+     * @function measureLatency
+     * @param name of histograms, probes of same name share them
+     * @return Stream
+     *
+     * Records latency of each input into histograms and outputs it as is: end-to-end from the time
+     * the producer emitted the value, or for a Queue the time it was pushed, and stage time from the previous
+     * `measureLatency` of the same flow. Delays keep the time, other Streams that hold values restart it, and
+     * so does each `async` thread hop, thus end-to-end time after `async` starts from the hop.
+     * Values are timestamped only while there are latency probes. See `latencyStats` and `dumpLatency`,
+     * percentiles are also in `stats` of this Stream.
+     *
+     */
+    Stream measureLatency(const QString& name);
+
+    /**
+     * @function enableStats
+     * @return Stream
+     *
+     * Starts collecting statistics of this Stream and the Streams it is connected from: number of inputs,
+     * outputs, errors and time spent in callbacks. Counters have a little cost, thus they are not on by default.
+     *
+     */
+    Stream enableStats();
+
+    /**
+     * @function stats
+     * @return list of maps
+     *
+     * Statistics of this Stream and the Streams it is connected from, starting from the producer.
+     * Each map has "type", "id", "in", "out", "errors", "callbacks", "callbackUs" and "outPerSec", and if called
+     * in the Stream thread, "waiting" that tells if it is holding completion and "queued" number of values held.
+     * Only "type", "id", "waiting" and "queued" are available if `enableStats` is not called.
+     *
+     */
+    QVariantList stats() const;
+
+    /**
+     * @function graph
+     * @return map
+     *
+     * Description of the pipeline this Stream belongs to, starting from its producer: "root", "thread",
+     * "nodes" that are maps as in `stats`, and "edges" that are pairs of node ids.
+     * Must be called in the Stream thread.
+     *
+     */
+    QVariantMap graph() const;
+
+    /**
+     * @function lines
+     * @return Stream
+     *
+     * Splits QByteArray inputs into lines and outputs them as Axq::Lines batches, lines spanning
+     * over inputs are joined. An input that has no partial line from previous input is not copied.
+     *
+     */
+    Stream lines();
+
 
     template<class O, typename F>
     /**
@@ -496,10 +781,11 @@ public:
     Stream scan(const S& begin, std::function<void (S&, const T&)> onScan) {
         auto acc = new S(begin);
         own(acc);
+        Converter<T> in;
         return createScan([acc]() {
             return convertFrom(*acc);
-        },  [onScan, acc](const QVariant & v) {
-            onScan(*acc, convert<T>(v));
+        },  [onScan, acc, in](const QVariant & v) mutable {
+            onScan(*acc, in(v));
         });
     }
 
@@ -523,17 +809,29 @@ public:
      * Stream::Index - index of current input
      * Stream::This - pointer to the current Stream
      *
+     * For Stream::Index the function can be omitted, then the output is std::tuple<T, ulong> of value and index.
+     *
      */
     Stream meta(std::function<O(const T&, ulong)> f) {
-        return createInfo(static_cast<Axq::Stream::InfoValues>(INFO::Index), [f](const QVariant & var, const QVariant & data) {
-            return convertFrom<O>(f(convert<T>(var), data.value<ulong>()));
+        Converter<T> in;
+        return createInfo(static_cast<Axq::Stream::InfoValues>(INFO::Index), [f, in](const QVariant & var, const QVariant & data) mutable {
+            return convertFrom<O>(f(in(var), data.value<ulong>()));
+        });
+    }
+
+    template <typename T, typename INFO, typename = typename std::enable_if<std::is_same<INFO, Stream::Index>::value>::type>
+    Stream meta() {
+        Converter<T> in;
+        return createInfo(static_cast<Axq::Stream::InfoValues>(INFO::Index), [in](const QVariant & var, const QVariant & data) mutable {
+            return boxed(std::make_tuple(in(var), data.value<ulong>()));
         });
     }
 
     template <typename O, typename T, typename INFO, typename = std::enable_if<std::is_same<INFO, Stream::This>::value>>
     Stream meta(std::function<O(const T&, Stream)> f) {
-        return createInfo(static_cast<Axq::Stream::InfoValues>(INFO::This), [f](const QVariant & var, const QVariant & data) {
-            return convertFrom<O>(f(convert<T>(var), data.value<Stream>()));
+        Converter<T> in;
+        return createInfo(static_cast<Axq::Stream::InfoValues>(INFO::This), [f, in](const QVariant & var, const QVariant & data) mutable {
+            return convertFrom<O>(f(in(var), data.value<Stream>()));
         });
     }
 
@@ -587,8 +885,9 @@ public:
      *
      */
     Stream iterate(std::function<QList<O> (const I& stream)> onIter) {
-        return createList([onIter](const QVariant & var) {
-            return convertFrom<QList<O>>(onIter(convert<I>(var)));
+        Converter<I> in;
+        return createList([onIter, in](const QVariant & var) mutable {
+            return convertFrom<QList<O>>(onIter(in(var)));
         });
     }
     Stream iterate();
@@ -596,13 +895,17 @@ public:
     /**
      * @function buffer
      * @param max int (defaults to big value)
+     * @param spillBytes optional, approximate size in bytes kept in memory
      * @return
      *
      * Collects stream input into Axq::Params and output is completed or there size of buffer exceeds given max value.
+     * If `spillBytes` is given, a buffer that grows over it is moved into a temporary file, and its output is read
+     * back from there by `iterate` without loading it all into memory. Values are written using Axq::Codec.
+     * If a value cannot be written, an error is emitted and the buffer is kept in memory.
      *
      */
-    Stream buffer(int max = 0xFFFFF - 1) {
-        return createBuffer(max);
+    Stream buffer(int max = 0xFFFFF - 1, qint64 spillBytes = 0) {
+        return createBuffer(max, spillBytes);
     }
 
 
@@ -619,6 +922,49 @@ public:
         return createDelay(delayMs);
     }
 
+    /**
+     * @function debounce
+     * @param ms milliseconds
+     * @return Stream
+     *
+     * Outputs an input only after there has been no other input for a given period, i.e. a burst
+     * is reduced to its last value. A pending value is output when the Stream completes.
+     *
+     */
+    Stream debounce(int ms);
+
+    /**
+     * @function throttleFirst
+     * @param ms milliseconds
+     * @return Stream
+     *
+     * Outputs an input and then ignores inputs for a given period.
+     *
+     */
+    Stream throttleFirst(int ms);
+
+    /**
+     * @function throttleLatest
+     * @param ms milliseconds
+     * @return Stream
+     *
+     * Outputs an input and then at most one input per a given period, the latest one received
+     * during the period. A pending value is output when the Stream completes.
+     *
+     */
+    Stream throttleLatest(int ms);
+
+    /**
+     * @function sample
+     * @param ms milliseconds
+     * @return Stream
+     *
+     * Outputs the latest input periodically, if there has been an input since the previous output.
+     * A pending value is output when the Stream completes.
+     *
+     */
+    Stream sample(int ms);
+
 
     template < typename T, typename = enable_if_t < !std::is_base_of<QObject, remove_pointer_t<T>>::value >>
     // template<typename T>
@@ -682,8 +1028,9 @@ public:
      *
      */
     Stream onError(std::function <void (const T&, int)> f) {
-        return onError([f](const QVariant & v, int code) {
-            f(convert<T>(v), code);
+        Converter<T> in;
+        return onError([f, in](const QVariant & v, int code) mutable {
+            f(in(v), code);
         });
     }
 
@@ -702,12 +1049,24 @@ public:
 
     template<typename T>
     Stream onCompleted(std::function <void (const T&)> last) {
-        return createOnCompleted([last](const QVariant & v) {
-            last(convert<T>(v));
+        Converter<T> in;
+        return createOnCompleted([last, in](const QVariant & v) mutable {
+            last(in(v));
         });
     }
 
-    Stream onBufferCompleted(std::function <void (const QByteArray&)> last);
+    /**
+     * @function onBufferCompleted
+     * @param function, F(bytes)->void
+     * @param reserve optional expected total size in bytes
+     * @return Stream
+     *
+     * Appends inputs as QByteArray into a single buffer as they are received and calls the given function
+     * with it when the Stream is completed. List inputs (e.g. from `buffer`) are appended item by item.
+     * If the total size is known, reserving it avoids reallocations.
+     *
+     */
+    Stream onBufferCompleted(std::function <void (const QByteArray&)> last, int reserve = 0);
 
     /**
      * @function request
@@ -771,14 +1130,16 @@ protected:
 private:
     static QList<StreamBase*> mapToStream(const QList<Stream>& sources);
     static QList<ProducerBase*> mapToProducer(const QList<Stream>& sources);
-    Stream createEach(std::function<void (const QVariant&)>);
+    Stream createEach(Callable<void (const QVariant&)>);
     Stream createDelay(int delayMs);
-    Stream createBuffer(int max);
+    Stream createBuffer(int max, qint64 spillBytes);
     Stream createCompleteFilter(std::function<bool (const QVariant&)>);
-    Stream createMap(std::function<QVariant(const QVariant&)>);
-    Stream createFilter(std::function<bool (const QVariant&)>);
+    Stream createTake(int count, std::function<bool (const QVariant&)>);
+    Stream createSkip(int count, std::function<bool (const QVariant&)>);
+    Stream createMap(Callable<QVariant(const QVariant&)>);
+    Stream createFilter(Callable<QVariant(const QVariant&)>);
     Stream createSpawn(std::function<Stream(const QVariant&)>);
-    Stream createScan(std::function<QVariant()>, std::function<void (const QVariant&)>);
+    Stream createScan(Callable<QVariant()>, Callable<void (const QVariant&)>);
     Stream createInfo(Axq::Stream::InfoValues intoType, std::function<QVariant(const QVariant&, const QVariant&)>);
     Stream createList(std::function<QVariant(const QVariant&)>);
     Stream createOwner(Keeper* deleter);
@@ -794,14 +1155,68 @@ private:
 // These here to keep private
     static Stream createContainer(const QVariant& container);
 
-    static Stream createRepeater(std::function<QVariant()> function, int intervalMs);
-    static Stream createIterator(Keeper* iterator, std::function<bool ()> hasNext, std::function<QVariant()> next);
-    static Stream create(std::function<QVariant()> function);
+    static Stream createRepeater(Callable<QVariant()> function, int intervalMs);
+    static Stream createIterator(Keeper* iterator, Callable<bool ()> hasNext, Callable<QVariant()> next);
+    static Stream createIndexed(qint64 count, Callable<QVariant(qint64)> at);
+    static Stream createRange(qint64 begin, qint64 end, qint64 step, int blockSize);
+    static Stream createRange(double begin, double end, double step, int blockSize);
+    static Stream create(Callable<QVariant()> function);
     static Stream create(QIODevice* device, int len);
 
     template <typename T> static T convert(const QVariant& val);
     template <typename T> static T convert(QVariant& val);
 
+    /*
+     * Converts values to T as convert does, but the way is resolved only when the value type changes,
+     * an exactly matching value is read in place.
+     */
+    template <typename T> class Converter {
+    public:
+        const T& operator()(const QVariant& val) {
+            if(val.userType() != m_type) {
+                resolve(val);
+            }
+            switch(m_plan) {
+            case Plan::Direct:
+                return *static_cast<const T*>(val.constData());
+            case Plan::Value:
+                m_value = val.value<T>();
+                return m_value;
+            default:
+                m_value = T{};
+                convertTo(m_value, val);
+                return m_value;
+            }
+        }
+    private:
+        enum class Plan {Direct, Value, Rebuild};
+        void resolve(const QVariant& val) {
+            m_type = val.userType();
+            m_plan = m_type == qMetaTypeId<T>() ? Plan::Direct : val.canConvert<T>() ? Plan::Value : Plan::Rebuild;
+        }
+    private:
+        int m_type = QMetaType::UnknownType;
+        Plan m_plan = Plan::Rebuild;
+        T m_value{};
+    };
+
+    template <typename ...Args> class Converter<std::tuple<Args...>> {
+    public:
+        const std::tuple<Args...>& operator()(const QVariant& val) {
+            if(val.userType() == qMetaTypeId<Tuple>()) {
+                const auto tuple = static_cast<const Tuple*>(val.constData())->template as<Args...>();
+                if(tuple) {
+                    return *tuple;
+                }
+            }
+            m_value = std::tuple<Args...>();
+            _TupleList<0, sizeof...(Args)>::from(val.toList(), m_value); //ParamList or other Tuple
+            return m_value;
+        }
+    private:
+        std::tuple<Args...> m_value;
+    };
+
     static constexpr auto EXTRARESERVE = 10;
 
     template <typename K, typename V> static void convertTo(QHash<K, V>& hash,  const QVariant& val) {
@@ -846,9 +1261,19 @@ private:
 
     template <typename T>
     static QVariant convertFrom(const T& val) {
+        return boxed(val);
+    }
+
+    template <typename T>
+    static QVariant boxed(const T& val) {
         return QVariant::fromValue<T>(val);
     }
 
+    template <typename ...Args>
+    static QVariant boxed(const std::tuple<Args...>& val) {
+        return QVariant::fromValue<Tuple>(Tuple(val));
+    }
+
     template <typename T>
     static QVariant convertFrom(const QHash<QString, T>& val) {
         QVariantHash hash;
@@ -898,7 +1323,11 @@ private:
     template <class T, typename> friend T async(const T& stream);
     template <typename ...Args> friend ParamList params(Args...args);
     template <typename T> friend Stream create(std::function<T()> function);
-    template <class T, class inputIt> friend Stream iterator(inputIt begin, inputIt end);
+    template <class T, class inputIt> friend Stream _iterator(inputIt begin, inputIt end, std::input_iterator_tag);
+    template <class T, class inputIt> friend Stream _iterator(inputIt begin, inputIt end, std::random_access_iterator_tag);
+    template <class T, class randomIt> friend Stream _blocks(randomIt begin, randomIt end, int blockSize);
+    template <typename T> friend Stream _range(T begin, T end, T step, int blockSize);
+    template <typename T, typename C> friend Stream _fromOwned(C&& container);
     template <typename T, class IT> friend Stream iterator(const IT& it);
     template <typename T> friend Stream iterator(const QString& it);
     friend class Queue;
@@ -993,6 +1422,190 @@ AXQSHAREDLIB_EXPORT Stream create(Queue* queue);
  */
 AXQSHAREDLIB_EXPORT Stream read(QIODevice* device, int len = Stream::OneLine);
 
+/**
+ * @function readMapped
+ * @param QFile* that is memory mapped for data, if the file is not having a parent, the Stream will take it.
+ * @param spesifies the length of output, `Stream::OneLine` outputs one line, `Stream::Slurp` all content and any positive value fixed length records.
+ * @return Stream
+ *
+ * Reads file content on the stream as `read` does, but outputs QByteArrays that are views to the memory
+ * mapping and thus nothing is copied nor read per output. The mapping is kept until the Stream is deleted
+ * and the views passed on (e.g. to `async` or `buffer`) are released, thus a view stays valid as long as it is held.
+ * A record may be accessed as type, e.g. `reinterpret_cast<const T*>(view.constData())`.
+ * If the file cannot be mapped, it is read as `read` does.
+ *
+ */
+AXQSHAREDLIB_EXPORT Stream readMapped(QFile* file, int len = Stream::OneLine);
+
+/**
+ * @function lines
+ * @param QIODevice* that is read for data, if the device is not having a parent, the Stream will take it.
+ * @param size of read block in bytes
+ * @return Stream
+ *
+ * Reads data from the QIODevice in blocks and outputs each block as Axq::Lines batch, a
+ * line spanning over blocks is carried to the next batch. Newlines are searched using SIMD
+ * instructions when available. Compared to `read(device, Stream::OneLine)` there is no per
+ * line read nor allocation.
+ *
+ */
+AXQSHAREDLIB_EXPORT Stream lines(QIODevice* device, int blockSize = 0x100000);
+
+/**
+ * @function asyncRead
+ * @param path of file to read
+ * or
+ * @param QIODevice* to read, the Stream will take it. The device must not have a parent, otherwise it is read as `read` does.
+ * @param size of chunk in bytes
+ * @param depth number of chunks read ahead
+ * @return Stream
+ *
+ * Reads data in a background thread and outputs it in QByteArray chunks. The thread keeps up to `depth`
+ * chunks read ahead in a ring of reused buffers, thus reading overlaps with processing and a slow device
+ * does not block the Stream thread. A chunk buffer is reused only once it is not referenced anymore.
+ *
+ */
+AXQSHAREDLIB_EXPORT Stream asyncRead(const QString& path, int chunkSize = 0x10000, int depth = 2);
+AXQSHAREDLIB_EXPORT Stream asyncRead(QIODevice* device, int chunkSize = 0x10000, int depth = 2);
+
+/**
+ * @function fromLocalSocket
+ * @param name of local server, see QLocalServer
+ * @param window number of inputs the sender may have unacknowledged, should be same as on sending end
+ * @return Stream
+ *
+ * Listens a local server and outputs values, errors and completion sent by `toLocalSocket` using
+ * the same name. A deferred Stream stops acknowledging, and thus the sending producer is deferred as well.
+ *
+ */
+AXQSHAREDLIB_EXPORT Stream fromLocalSocket(const QString& name, int window = 64);
+
+/**
+ * @function replay
+ * @param path base name of journal files, see `journal`
+ * @param fromOffset number of the first record to output
+ * @return Stream
+ *
+ * Outputs values of a journal written by `journal`, starting from the record at `fromOffset`.
+ * Files are memory mapped and read as the Stream requests.
+ *
+ */
+AXQSHAREDLIB_EXPORT Stream replay(const QString& path, qint64 fromOffset = 0);
+
+/**
+ * @function allStats
+ * @return list of maps
+ *
+ * Statistics of all existing Streams that have `enableStats` called, see `stats`.
+ * Can be called from any thread, the maps have "thread" name instead of "waiting" and "queued".
+ *
+ */
+AXQSHAREDLIB_EXPORT QVariantList allStats();
+
+/**
+ * Output format of `dumpGraph`
+ */
+enum class GraphFormat {Dot, Json};
+
+/**
+ * @function dumpGraph
+ * @param format Dot or Json
+ * @return graph description
+ *
+ * Describes every live pipeline, see `graph`, as Graphviz DOT or as JSON list. In DOT each thread
+ * is a cluster and Streams holding completion are red. Pipelines of other threads are read in their
+ * threads, a thread that does not respond in a second is reported "unresponsive".
+ * Can be called from any thread.
+ *
+ */
+AXQSHAREDLIB_EXPORT QByteArray dumpGraph(GraphFormat format = GraphFormat::Dot);
+
+/**
+ * @function setAccounting
+ * @param enabled
+ * @param sampleInterval creation stack is kept for every Nth object, 0 keeps none
+ *
+ * Turns object accounting on or off. When on, created and destroyed Streams, QML Streams and their
+ * owners are counted by class in each thread, and creation stacks of sampled objects are kept
+ * until they are destroyed. Objects are accounted only if created while on. Accounting can be
+ * turned on also by setting environment variable AXQ_ACCOUNTING to the sample interval.
+ *
+ */
+AXQSHAREDLIB_EXPORT void setAccounting(bool enabled, int sampleInterval = 100);
+
+/**
+ * @function accountingReport
+ * @return map
+ *
+ * Accounting counts, see `setAccounting`: "classes" has "created", "destroyed" and "live" counts
+ * by class name, "threads" has the same per thread, and "samples" lists live sampled objects
+ * with "type", "ageMs", "thread" and creation "stack". Long living samples are leak suspects.
+ * Can be called from any thread.
+ *
+ */
+AXQSHAREDLIB_EXPORT QVariantMap accountingReport();
+
+/**
+ * @function latencyStats
+ * @return map
+ *
+ * Latency histograms by `measureLatency` name: "endToEnd" and "stage" maps that have "count",
+ * "minUs", "meanUs", "maxUs", "p50Us", "p99Us" and "p999Us". Can be called from any thread.
+ *
+ */
+AXQSHAREDLIB_EXPORT QVariantMap latencyStats();
+
+/**
+ * @function dumpLatency
+ * @return text
+ *
+ * Percentile distribution of all latency histograms as text, see `measureLatency`.
+ * Can be called from any thread.
+ *
+ */
+AXQSHAREDLIB_EXPORT QByteArray dumpLatency();
+
+/**
+ * @function startTrace
+ *
+ * Starts recording Stream events: callbacks, producer ticks, delays, thread hops, completions
+ * and errors. Each thread records into its own buffer, thus recording does not lock.
+ * Completion handshake is recorded for Streams created after tracing is started.
+ * A previous recording is discarded.
+ *
+ */
+AXQSHAREDLIB_EXPORT void startTrace();
+
+/**
+ * @function stopTrace
+ *
+ * Stops recording Stream events, the recorded events are kept until `startTrace` is called again.
+ *
+ */
+AXQSHAREDLIB_EXPORT void stopTrace();
+
+/**
+ * @function writeTrace
+ * @param path of file to write
+ * @return true if written, false if not written or tracing is not stopped
+ *
+ * Writes recorded events as Chrome Trace Event JSON, that can be opened with Perfetto or chrome://tracing.
+ * Recording has to be stopped with `stopTrace` first, and not started again before this returns.
+ *
+ */
+AXQSHAREDLIB_EXPORT bool writeTrace(const QString& path);
+
+/**
+ * @function poolStats
+ * @return map
+ *
+ * Memory of Stream nodes: "enabled" is false if the library is built with AXQ_NO_NODE_POOL,
+ * "chunks" and "bytes" tell what the pool has taken from heap. Chunks are not freed, but nodes
+ * of deleted Streams are reused. Can be called from any thread.
+ *
+ */
+AXQSHAREDLIB_EXPORT QVariantMap poolStats();
+
 template <typename T>
 /**
  * @function repeater
@@ -1026,17 +1639,7 @@ Stream repeater(int intervalMs, const T& value) {
 }
 
 template <class T, class inputIt>
-/**
- * @function iterator
- * @templateparam type of iterated value
- * @param begin input iterator to start
- * @param end input iterator to end
- * @return Stream
- *
- * Iterates the given input iterator values into stream.
- *
- */
-Stream iterator(inputIt begin, inputIt end) {
+Stream _iterator(inputIt begin, inputIt end, std::input_iterator_tag) {
     class Begin : public Stream::Keeper {
     public:
         Begin(inputIt iptr) : iter(iptr) {}
@@ -1053,6 +1656,94 @@ Stream iterator(inputIt begin, inputIt end) {
     });
 }
 
+template <class T, class inputIt>
+Stream _iterator(inputIt begin, inputIt end, std::random_access_iterator_tag) {
+    using Diff = typename std::iterator_traits<inputIt>::difference_type;
+    return Stream::createIndexed(static_cast<qint64>(end - begin), [begin](qint64 index) {
+        return QVariant::fromValue<T>(begin[static_cast<Diff>(index)]);
+    });
+}
+
+template <class T, class inputIt>
+/**
+ * @function iterator
+ * @templateparam type of iterated value
+ * @param begin input iterator to start
+ * @param end input iterator to end
+ * @return Stream
+ *
+ * Iterates the given input iterator values into stream. Random access iterators are accessed by index
+ * and not copied to keep the position.
+ *
+ */
+Stream iterator(inputIt begin, inputIt end) {
+    return _iterator<T>(begin, end, typename std::iterator_traits<inputIt>::iterator_category());
+}
+
+template <class T, class randomIt>
+Stream _blocks(randomIt begin, randomIt end, int blockSize) {
+    static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<randomIt>::iterator_category>::value,
+                  "blocks requires random access iterators");
+    using Diff = typename std::iterator_traits<randomIt>::difference_type;
+    const qint64 size = static_cast<qint64>(end - begin);
+    const qint64 block = std::max(1, blockSize);
+    return Stream::createIndexed((size + block - 1) / block, [begin, size, block](qint64 index) {
+        const auto first = begin + static_cast<Diff>(index * block);
+        const auto last = begin + static_cast<Diff>(std::min(size, (index + 1) * block));
+        QVector<T> values;
+        values.reserve(static_cast<int>(last - first));
+        for(auto it = first; it != last; ++it) {
+            values.append(*it);
+        }
+        return QVariant::fromValue<QVector<T>>(values);
+    });
+}
+
+template <class T, class randomIt>
+/**
+ * @function blocks
+ * @templateparam type of iterated value
+ * @param begin random access iterator to start
+ * @param end random access iterator to end
+ * @param blockSize maximum number of values in an output
+ * @return Stream
+ *
+ * Outputs values between iterators as QVector<T> blocks, thus a large container is not iterated
+ * one value per output. Use `iterate` to output values individually.
+ *
+ */
+Stream blocks(randomIt begin, randomIt end, int blockSize = 0x1000) {
+    return _blocks<T>(begin, end, blockSize);
+}
+
+template <class T, class randomIt>
+/**
+ * @function partition
+ * @templateparam type of iterated value
+ * @param begin random access iterator to start
+ * @param end random access iterator to end
+ * @param parts number of Streams
+ * @param blockSize if greater than 0 values are output as `blocks` does, otherwise as `iterator` does
+ * @return list of Streams
+ *
+ * Splits values between iterators into contiguous ranges of about equal size, each iterated
+ * by its own Stream. The Streams can be processed in parallel, e.g. using `async`, and combined
+ * with `merge`. The iterated container must outlive the Streams.
+ *
+ */
+QList<Stream> partition(randomIt begin, randomIt end, int parts, int blockSize = 0) {
+    using Diff = typename std::iterator_traits<randomIt>::difference_type;
+    const qint64 size = static_cast<qint64>(end - begin);
+    const qint64 count = std::max<qint64>(1, std::min<qint64>(parts, size));
+    QList<Stream> streams;
+    for(qint64 i = 0; i < count; i++) {
+        const auto first = begin + static_cast<Diff>(size * i / count);
+        const auto last = begin + static_cast<Diff>(size * (i + 1) / count);
+        streams.append(blockSize > 0 ? blocks<T>(first, last, blockSize) : iterator<T>(first, last));
+    }
+    return streams;
+}
+
 
 template <typename T, class IT>
 /**
@@ -1137,13 +1828,63 @@ template <class T>
  * If container can resolve to QList, QVector, QHash or QMap its values are iterated into Stream, otherwise
  * value is put into Stream as-is.
  */
-Stream from(const T& container, typename std::enable_if < !std::is_pointer<T>::value >::type* = 0) { //no move :(
+Stream from(const T& container, typename std::enable_if < !std::is_pointer<T>::value >::type* = 0) {
     return _from(container);
 }
 
+/**
+ * @function from
+ * @param list, map or hash to move into Stream
+ * @return Stream
+ *
+ * Takes the given container and iterates its values into Stream without copying it.
+ */
+AXQSHAREDLIB_EXPORT Stream from(QVariantList&& list);
+AXQSHAREDLIB_EXPORT Stream from(QVariantMap&& map);
+AXQSHAREDLIB_EXPORT Stream from(QVariantHash&& hash);
+
+template <typename T, typename C>
+Stream _fromOwned(C&& container) {
+    using Size = typename C::size_type;
+    const auto values = std::make_shared<const C>(std::move(container));
+    return Stream::createIndexed(static_cast<qint64>(values->size()), [values](qint64 index) {
+        return QVariant::fromValue<T>((*values)[static_cast<Size>(index)]);
+    });
+}
+
+template <typename T>
+/**
+ * @function from
+ * @param std::vector, QVector or QList to move into Stream
+ * @return Stream
+ *
+ * Takes the given container and iterates its values into Stream. Values are not converted
+ * to QVariant before they are output, thus a large container is available without copies.
+ */
+Stream from(std::vector<T>&& container) {
+    return _fromOwned<T>(std::move(container));
+}
+
+template <typename T>
+Stream from(QVector<T>&& container) {
+    return _fromOwned<T>(std::move(container));
+}
+
+template <typename T>
+Stream from(QList<T>&& container) {
+    return _fromOwned<T>(std::move(container));
+}
+
 
 AXQSHAREDLIB_EXPORT Stream range(int begin, int end, int step = 1);
 
+template <typename T>
+Stream _range(T begin, T end, T step, int blockSize) {
+    static_assert(std::is_arithmetic<T>::value, "range requires arithmetic type");
+    using Wide = typename std::conditional<std::is_floating_point<T>::value, double, qint64>::type;
+    return Stream::createRange(static_cast<Wide>(begin), static_cast<Wide>(end), static_cast<Wide>(step), blockSize);
+}
+
 template <typename T>
 /**
  * @function range
@@ -1153,11 +1894,29 @@ template <typename T>
  * @return Stream
  *
  *
- * Puts values into Stream. Values are assumed to be integers.
+ * Puts values from begin to end (exclusive) into Stream. Integer types are output as qint64,
+ * floating point types as double. A negative step counts down.
  *
  */
 Stream range(T begin, T end, T step = 1) {
-    return range(static_cast<int>(begin), static_cast<int>(end), static_cast<int>(step));
+    return _range(begin, end, step, 0);
+}
+
+template <typename T>
+/**
+ * @function rangeBlocks
+ * @param begin
+ * @param end
+ * @param step
+ * @param blockSize number of values in an output
+ * @return Stream
+ *
+ * As `range`, but outputs values in QVector<qint64> or QVector<double> blocks, thus large ranges
+ * are not iterated one value per output. Use `iterate` to output values individually.
+ *
+ */
+Stream rangeBlocks(T begin, T end, T step = 1, int blockSize = 0x1000) {
+    return _range(begin, end, step, blockSize);
 }
 
 
@@ -1225,6 +1984,8 @@ ParamList params(Args...args) {
   */
 
 Q_DECLARE_METATYPE(Axq::Stream)
+Q_DECLARE_METATYPE(Axq::Lines)
+Q_DECLARE_METATYPE(Axq::Tuple)
 Q_DECLARE_METATYPE(std::function<Axq::Stream()>)
 
 
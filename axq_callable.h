@@ -0,0 +1,150 @@
+#ifndef AXQ_CALLABLE_H
+#define AXQ_CALLABLE_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Axq {
+
+/// @cond
+template <typename Signature, std::size_t Capacity = 8 * sizeof(void*)>
+class Callable;
+
+/*
+ * Move only function wrapper that keeps a callable of up to Capacity bytes inline, a larger one is
+ * allocated. Unlike std::function, wrapping a lambda that captures a std::function or another
+ * small lambda does not allocate. Target is called as mutable, as std::function does.
+ */
+template <typename R, typename ...Args, std::size_t Capacity>
+class Callable<R(Args...), Capacity> {
+    static_assert(Capacity >= sizeof(void*), "Capacity must hold at least a pointer");
+public:
+    Callable() {}
+    Callable(std::nullptr_t) {}
+    template <typename F, typename = typename std::enable_if <
+                  !std::is_same<typename std::decay<F>::type, Callable>::value &&
+                  !std::is_same<typename std::decay<F>::type, std::nullptr_t>::value >::type >
+    Callable(F&& f) {
+        init<typename std::decay<F>::type>(std::forward<F>(f));
+    }
+    Callable(Callable&& other) noexcept {
+        take(other);
+    }
+    Callable& operator=(Callable&& other) noexcept {
+        if(this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+    Callable& operator=(std::nullptr_t) {
+        reset();
+        return *this;
+    }
+    Callable(const Callable&) = delete;
+    Callable& operator=(const Callable&) = delete;
+    ~Callable() {
+        reset();
+    }
+    explicit operator bool() const {
+        return m_ops != nullptr;
+    }
+    friend bool operator==(const Callable& c, std::nullptr_t) {
+        return !c;
+    }
+    friend bool operator!=(const Callable& c, std::nullptr_t) {
+        return static_cast<bool>(c);
+    }
+    R operator()(Args... args) const {
+        return m_ops->invoke(&m_storage, std::forward<Args>(args)...);
+    }
+private:
+    using Storage = typename std::aligned_storage<Capacity, alignof(std::max_align_t)>::type;
+    struct Ops {
+        R (*invoke)(void* target, Args&&... args);
+        void (*move)(Storage& to, Storage& from);   //leaves from destroyed
+        void (*destroy)(Storage& storage);
+    };
+    template <typename F>
+    struct Inline {
+        static R invoke(void* target, Args&&... args) {
+            return (*static_cast<F*>(target))(std::forward<Args>(args)...);
+        }
+        static void move(Storage& to, Storage& from) {
+            auto f = reinterpret_cast<F*>(&from);
+            ::new (static_cast<void*>(&to)) F(std::move(*f));
+            f->~F();
+        }
+        static void destroy(Storage& storage) {
+            reinterpret_cast<F*>(&storage)->~F();
+        }
+    };
+    template <typename F>
+    struct Allocated {
+        static R invoke(void* target, Args&&... args) {
+            return (**static_cast<F**>(target))(std::forward<Args>(args)...);
+        }
+        static void move(Storage& to, Storage& from) {
+            *reinterpret_cast<F**>(&to) = *reinterpret_cast<F**>(&from);
+        }
+        static void destroy(Storage& storage) {
+            delete *reinterpret_cast<F**>(&storage);
+        }
+    };
+    template <typename S>
+    static bool isNull(const std::function<S>& f) {
+        return !f;
+    }
+    template <typename S>
+    static bool isNull(S* f) {
+        return f == nullptr;
+    }
+    template <typename F>
+    static bool isNull(const F&) {
+        return false;
+    }
+    template <typename F, typename A>
+    void init(A&& f) {
+        if(isNull(f)) {
+            return; //an empty std::function or null function pointer makes an empty Callable
+        }
+        emplace<F>(std::forward<A>(f), std::integral_constant<bool, sizeof(F) <= Capacity &&
+                   alignof(F) <= alignof(Storage) && std::is_nothrow_move_constructible<F>::value>());
+    }
+    template <typename F, typename A>
+    void emplace(A&& f, std::true_type) {
+        ::new (static_cast<void*>(&m_storage)) F(std::forward<A>(f));
+        static const Ops ops = {&Inline<F>::invoke, &Inline<F>::move, &Inline<F>::destroy};
+        m_ops = &ops;
+    }
+    template <typename F, typename A>
+    void emplace(A&& f, std::false_type) {
+        *reinterpret_cast<F**>(&m_storage) = new F(std::forward<A>(f));
+        static const Ops ops = {&Allocated<F>::invoke, &Allocated<F>::move, &Allocated<F>::destroy};
+        m_ops = &ops;
+    }
+    void take(Callable& other) {
+        if(other.m_ops) {
+            other.m_ops->move(m_storage, other.m_storage);
+            m_ops = other.m_ops;
+            other.m_ops = nullptr;
+        }
+    }
+    void reset() {
+        if(m_ops) {
+            m_ops->destroy(m_storage);
+            m_ops = nullptr;
+        }
+    }
+private:
+    mutable Storage m_storage;
+    const Ops* m_ops = nullptr;
+};
+/// @endcond
+
+}
+
+#endif // AXQ_CALLABLE_H
@@ -0,0 +1,44 @@
+#ifndef AXQ_CODEC_H
+#define AXQ_CODEC_H
+
+#include <functional>
+#include <QByteArray>
+#include <QVariant>
+#include "axq.h"
+
+namespace Axq {
+
+/**
+ * Binary format for Stream values. Values are tagged, integers are (zigzag) varints, strings latin1
+ * when possible and lists of ints or doubles are written as batches. Types that are not known nor
+ * registered are written using QDataStream. The format version is written by `header`, for the
+ * containers (files, sockets) that carry encoded values.
+ */
+class AXQSHAREDLIB_EXPORT Codec {
+public:
+    static constexpr quint8 Version = 1;
+    static constexpr int HeaderSize = 5;
+    using Encoder = std::function<bool (const QVariant& value, QByteArray& out)>;
+    using Decoder = std::function<bool (const char*& pos, const char* end, QVariant& value)>;
+    /**
+     * Appends value into out, on failure nothing is appended and false returned.
+     */
+    static bool encode(const QVariant& value, QByteArray& out);
+    /**
+     * Reads a value from pos and moves pos over it, false if data is not valid.
+     */
+    static bool decode(const char*& pos, const char* end, QVariant& value);
+    static QVariant decode(const QByteArray& bytes);
+    /**
+     * Set encoder and decoder for a type, decoder shall read exactly what encoder has written.
+     */
+    static void registerType(int metaTypeId, Encoder encoder, Decoder decoder);
+    static void header(QByteArray& out);
+    static bool checkHeader(const char*& pos, const char* end);
+    static void putVarint(QByteArray& out, quint64 value);
+    static bool getVarint(const char*& pos, const char* end, quint64& value);
+};
+
+}
+
+#endif // AXQ_CODEC_H
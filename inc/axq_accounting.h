@@ -0,0 +1,72 @@
+#ifndef AXQ_ACCOUNTING_H
+#define AXQ_ACCOUNTING_H
+
+#include <atomic>
+#include <QVariant>
+
+class QObject;
+
+namespace Axq {
+
+/*
+ * Counts created and destroyed objects by class in per thread counters, and keeps the creation
+ * stack of every Nth object so that leaked ones can be located. Nothing is done unless enabled.
+ */
+class Accounting {
+public:
+    static bool enabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    static void setEnabled(bool enabled, int sampleInterval);
+    static QVariantMap report();
+private:
+    friend class Accounted;
+    static bool sample();
+    static void track(const QObject* object);
+    static void untrack(const QObject* object);
+    static void classify(const QObject* object, const char* kind, bool sampled);
+    static void count(const char* kind, bool allocated);
+    static std::atomic<bool> s_enabled;
+};
+
+/*
+ * Accounting state of an object, begin when created and classify once its class is known,
+ * that is not the case in base class constructors.
+ */
+class Accounted {
+public:
+    void begin(const QObject* object) {
+        if(Accounting::enabled()) {
+            m_begun = true;
+            m_sampled = Accounting::sample();
+            if(m_sampled) {
+                Accounting::track(object);
+            }
+        }
+    }
+    bool begun() const {
+        return m_begun;
+    }
+    void classify(const QObject* object, const char* kind) {
+        if(m_begun && !m_kind) {
+            m_kind = kind;
+            Accounting::classify(object, kind, m_sampled);
+        }
+    }
+    void end(const QObject* object) {
+        if(m_sampled) {
+            Accounting::untrack(object);
+        }
+        if(m_kind) {
+            Accounting::count(m_kind, false);
+        }
+    }
+private:
+    const char* m_kind = nullptr;
+    bool m_begun = false;
+    bool m_sampled = false;
+};
+
+}
+
+#endif // AXQ_ACCOUNTING_H
@@ -0,0 +1,26 @@
+#ifndef AXQ_GRAPH_H
+#define AXQ_GRAPH_H
+
+#include <QVariant>
+
+namespace Axq {
+
+class StreamBase;
+
+/*
+ * Per thread registry of root streams, so that all live pipelines can be described. A pipeline is
+ * read only in its own thread, pipelines of other threads are asked via their event loop.
+ */
+class Graph {
+public:
+    static void add(StreamBase* root);
+    static bool remove(StreamBase* root);    //true if was registered in this thread
+    static QVariantMap describe(StreamBase* root);
+    static QVariantList all(int timeoutMs = 1000);
+    static QByteArray dot(const QVariantList& graphs);
+    static QByteArray json(const QVariantList& graphs);
+};
+
+}
+
+#endif // AXQ_GRAPH_H
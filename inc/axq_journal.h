@@ -0,0 +1,58 @@
+#ifndef AXQ_JOURNAL_H
+#define AXQ_JOURNAL_H
+
+#include "axq_producer.h"
+#include "axq_operators.h"
+
+namespace Axq {
+
+class Journal : public Operator {
+    Q_OBJECT
+public:
+    Journal(const QString& path, int syncMs, qint64 segmentSize, StreamBase* parent);
+    ~Journal() Q_DECL_OVERRIDE;
+    bool open();
+    void cancel() Q_DECL_OVERRIDE;
+private:
+    void write(const QVariant& value);
+    bool recover(qint64 first, const QString& name);
+    bool openSegment(qint64 first, qint64 size);
+    void closeSegment();
+    void sync();
+private:
+    const QString m_path;
+    const qint64 m_segmentSize;
+    QFile* m_file = nullptr;
+    QFile* m_index = nullptr;
+    QTimer* m_timer = nullptr;
+    QByteArray m_payload;   //reused for each record
+    QByteArray m_length;
+    qint64 m_first = 0;     //number of first record in segment
+    qint64 m_next = 0;
+    bool m_dirty = false;
+};
+
+class Replay : public Serializer {
+    Q_OBJECT
+public:
+    Replay(const QString& path, qint64 from, std::nullptr_t);
+    bool hasData() const Q_DECL_OVERRIDE;
+    void cancel() Q_DECL_OVERRIDE;
+protected:
+    void onNext() Q_DECL_OVERRIDE;
+private:
+    bool openNext();
+    void seekIndex(const QString& name, const char* begin);
+    void closeSegment();
+private:
+    QList<QPair<qint64, QString>> m_segments;
+    QFile* m_file = nullptr;
+    const char* m_pos = nullptr;
+    const char* m_end = nullptr;
+    qint64 m_record = 0;
+    const qint64 m_from;
+};
+
+}
+
+#endif // AXQ_JOURNAL_H
@@ -0,0 +1,144 @@
+#ifndef AXQ_LATENCY_H
+#define AXQ_LATENCY_H
+
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <QMutex>
+#include <QVariant>
+
+namespace Axq {
+
+/*
+ * High dynamic range histogram of nanoseconds: each power of two range has SubHalf
+ * linear buckets, thus values are kept with better than 1% precision up to MaxBits.
+ * Recorded by one thread and read from any, counters are relaxed atomics.
+ */
+class Histogram {
+public:
+    Histogram();
+    void record(qint64 ns);
+    quint64 count() const;
+    qint64 percentile(double percent) const;
+    QVariantMap stats() const;
+private:
+    static int index(qint64 value);
+    static qint64 highest(int index);
+private:
+    static constexpr int SubBits = 8;
+    static constexpr int SubBuckets = 1 << SubBits;
+    static constexpr int SubHalf = SubBuckets / 2;
+    static constexpr int MaxBits = 44;   //about 4.8 hours
+    static constexpr int Buckets = MaxBits - SubBits + 1;
+    static constexpr int Counts = (Buckets + 1) * SubHalf;
+    std::unique_ptr<std::atomic<quint64>[]> m_counts;
+    std::atomic<quint64> m_total{0};
+    std::atomic<qint64> m_min{std::numeric_limits<qint64>::max()};
+    std::atomic<qint64> m_max{0};
+    std::atomic<qint64> m_sum{0};
+};
+
+struct LatencyHistograms {
+    Histogram endToEnd;     //from producer
+    Histogram stage;        //from previous probe
+};
+
+/*
+ * Origin time of the value currently passing in this thread, and the time it passed the
+ * previous probe. Zero origin means that values are not stamped.
+ */
+struct LatencyContext {
+    qint64 origin = 0;
+    qint64 checkpoint = 0;
+};
+
+class Latency {
+public:
+    static bool active() {
+        return s_probes.load(std::memory_order_relaxed) > 0;
+    }
+    static qint64 now();
+    static LatencyContext& context();
+    static std::shared_ptr<LatencyHistograms> histograms(const QString& name);
+    static QVariantMap all();
+    static QByteArray dump();
+private:
+    friend class LatencyProbe;
+    static std::atomic<int> s_probes;
+};
+
+/*
+ * Sets the context while a value is emitted and restores the previous one.
+ * Values are stamped only when there are probes.
+ */
+class LatencyScope {
+public:
+    explicit LatencyScope(qint64 origin = 0) {
+        if(origin > 0 || Latency::active()) {
+            set({origin > 0 ? origin : Latency::now(), 0});
+        }
+    }
+    explicit LatencyScope(const LatencyContext& context) {
+        if(context.origin > 0) {
+            set(context);
+        }
+    }
+    ~LatencyScope() {
+        if(m_set) {
+            Latency::context() = m_saved;
+        }
+    }
+    static LatencyContext current() {
+        return Latency::active() ? Latency::context() : LatencyContext();
+    }
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+private:
+    void set(LatencyContext context) {
+        auto& c = Latency::context();
+        m_saved = c;
+        m_set = true;
+        if(context.checkpoint == 0) {
+            context.checkpoint = context.origin;
+        }
+        c = context;
+    }
+private:
+    LatencyContext m_saved;
+    bool m_set = false;
+};
+
+/*
+ * Push times of a Queue, taken in the pushing thread and consumed in the order values
+ * are received by the producer.
+ */
+class LatencyStamps {
+public:
+    void push(qint64 ns) {
+        QMutexLocker lock(&m_mutex);
+        m_stamps.push_back(ns);
+        m_size.store(static_cast<int>(m_stamps.size()), std::memory_order_relaxed);
+    }
+    qint64 take() {
+        if(m_size.load(std::memory_order_relaxed) == 0) {
+            return 0;
+        }
+        QMutexLocker lock(&m_mutex);
+        if(m_stamps.empty()) {
+            return 0;
+        }
+        const auto ns = m_stamps.front();
+        m_stamps.pop_front();
+        m_size.store(static_cast<int>(m_stamps.size()), std::memory_order_relaxed);
+        return ns;
+    }
+private:
+    QMutex m_mutex;
+    std::deque<qint64> m_stamps;
+    std::atomic<int> m_size{0};
+};
+
+}
+
+#endif // AXQ_LATENCY_H
@@ -0,0 +1,42 @@
+#ifndef AXQ_LINES_H
+#define AXQ_LINES_H
+
+#include "axq.h"
+#include "axq_operators.h"
+
+namespace Axq {
+
+/**
+ * Appends position + offset of each '\n' in data into ends, vectorized when SSE2/AVX2 is available.
+ */
+void scanLines(const char* data, int size, int offset, QVector<int>& ends);
+
+class LineReader : public Serializer {
+    Q_OBJECT
+public:
+    LineReader(QIODevice* device, int blockSize, std::nullptr_t);
+    bool hasData() const Q_DECL_OVERRIDE;
+    void cancel() Q_DECL_OVERRIDE;
+protected:
+    void onNext() Q_DECL_OVERRIDE;
+private:
+    QIODevice* m_device;
+    const int m_blockSize;
+    QByteArray m_carry; //partial line from previous block
+};
+
+class LineSplitter : public Operator {
+    Q_OBJECT
+public:
+    LineSplitter(StreamBase* parent);
+    bool wait() const Q_DECL_OVERRIDE;
+    void cancel() Q_DECL_OVERRIDE;
+private:
+    void flush();
+private:
+    QByteArray m_carry;
+};
+
+}
+
+#endif // AXQ_LINES_H
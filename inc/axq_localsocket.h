@@ -0,0 +1,63 @@
+#ifndef AXQ_LOCALSOCKET_H
+#define AXQ_LOCALSOCKET_H
+
+#include "axq_producer.h"
+#include "axq_operators.h"
+
+class QLocalSocket;
+class QLocalServer;
+
+namespace Axq {
+
+class LocalSocketSink : public Operator {
+    Q_OBJECT
+public:
+    LocalSocketSink(const QString& name, int window, StreamBase* parent);
+    bool wait() const Q_DECL_OVERRIDE;
+    void cancel() Q_DECL_OVERRIDE;
+private:
+    void connectServer();
+    void send();
+    void onRead();
+    void done();
+private:
+    QLocalSocket* m_socket = nullptr;
+    QTimer* m_retry = nullptr;
+    const QString m_name;
+    const int m_window;
+    QByteArray m_frame;     //reused for each output
+    QByteArray m_unsent;    //frames until connected
+    QByteArray m_input;
+    int m_inFlight = 0;
+    bool m_deferred = false;
+    bool m_completing = false;
+    bool m_ended = false;   //complete sent or cancelled, later finished is ignored
+};
+
+class LocalSocketSource : public QueueProducer {
+    Q_OBJECT
+public:
+    LocalSocketSource(const QString& name, int window, std::nullptr_t);
+    bool listen();
+    void request(int milliseconds) Q_DECL_OVERRIDE;
+    void defer() Q_DECL_OVERRIDE;
+    void cancel() Q_DECL_OVERRIDE;
+private:
+    void onConnection();
+    void onRead();
+    void ack();
+private:
+    QLocalServer* m_server = nullptr;
+    QLocalSocket* m_socket = nullptr;
+    const QString m_name;
+    const int m_window;
+    QByteArray m_frame;
+    QByteArray m_input;
+    int m_unacked = 0;
+    bool m_deferred = false;
+    bool m_done = false;
+};
+
+}
+
+#endif // AXQ_LOCALSOCKET_H
@@ -0,0 +1,48 @@
+#ifndef AXQ_METRICS_H
+#define AXQ_METRICS_H
+
+#include <atomic>
+#include <QVariant>
+#include <QElapsedTimer>
+
+class QThread;
+
+namespace Axq {
+
+class StreamBase;
+
+/*
+ * Counters of a single stream. Updated in the stream thread and read from any thread, thus
+ * relaxed atomics are enough, the values are only statistics. Names are set when enabled,
+ * so other threads never touch the stream itself.
+ */
+class Metrics {
+public:
+    static void add(std::atomic<quint64>& counter, quint64 value = 1) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+    static quint64 get(const std::atomic<quint64>& counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+    static QVariantMap stats(const StreamBase* stream);
+    static QVariantList all();
+    static void enable(StreamBase* stream);
+    static void release(StreamBase* stream);
+    static QString threadName(const QThread* thread);
+private:
+    void append(QVariantMap& map) const;
+public:
+    std::atomic<quint64> in{0};
+    std::atomic<quint64> out{0};
+    std::atomic<quint64> errors{0};
+    std::atomic<quint64> callbacks{0};
+    std::atomic<quint64> callbackNs{0};
+    QElapsedTimer since;    //started when enabled, for rates
+    QString type;
+    QString id;
+    QString thread;
+};
+
+}
+
+#endif // AXQ_METRICS_H
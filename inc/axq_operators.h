@@ -21,10 +21,14 @@ class Map : public Operator {
     Q_OBJECT
 public:
     template<typename ...Args>
-    Map(std::function<QVariant(const QVariant&)> map, StreamBase* parent) : Operator(parent) {
+    Map(Callable<QVariant(const QVariant&)> map, StreamBase* parent) : Operator(parent) {
         //"this" in slot is very important, it tells that slot is executed in this-object thread instead of constructor time thread, which may differ
-        QObject::connect(m_parent, &StreamBase::next, this, [map, this](const QVariant & value) {
-            const auto v = map(value);
+        QObject::connect(m_parent, &StreamBase::next, this, [map = std::move(map), this](const QVariant & value) {
+            QVariant v;
+            {
+                CallbackScope scope(this);
+                v = map(value);
+            }
             emit next(v);
         });
     }
@@ -34,9 +38,13 @@ class Filter : public Operator {
     Q_OBJECT
 public:
     template<typename ...Args>
-    Filter(std::function<QVariant(const QVariant&)> filter, StreamBase* parent)  : Operator(parent) {
-        QObject::connect(m_parent, &StreamBase::next,  this, [this, filter](const QVariant & value) {
-            const auto v = filter(value);
+    Filter(Callable<QVariant(const QVariant&)> filter, StreamBase* parent)  : Operator(parent) {
+        QObject::connect(m_parent, &StreamBase::next,  this, [this, filter = std::move(filter)](const QVariant & value) {
+            QVariant v;
+            {
+                CallbackScope scope(this);
+                v = filter(value);
+            }
             if(v.isValid() && v.toBool()) {
                 emit next(value);
             }
@@ -58,8 +66,13 @@ public:
         switch(m_type) {
         case Index:
             QObject::connect(m_parent, &StreamBase::next,  this, [this, f](const QVariant & value) {
-                emit next(f(value, QVariant::fromValue<ulong>(m_count)));
+                QVariant v;
+                {
+                    CallbackScope scope(this);
+                    v = f(value, QVariant::fromValue<ulong>(m_count));
+                }
                 ++m_count;
+                emit next(v);
             });
             break;
         default:
@@ -77,6 +90,7 @@ public:
     Delay(StreamBase* parent, int ms);
     bool wait() const Q_DECL_OVERRIDE;
     void cancel() Q_DECL_OVERRIDE;
+    qint64 queued() const Q_DECL_OVERRIDE;
 protected:
     void initConnections() Q_DECL_OVERRIDE;
 private:
@@ -88,10 +102,55 @@ private:
 };
 
 
+/*
+ * Rate limiters share a single timer, the state is just the latest value.
+*/
+class Throttle : public Operator {
+    Q_OBJECT
+public:
+    enum Mode {Debounce, ThrottleFirst, ThrottleLatest, Sample};
+    Throttle(Mode mode, int ms, StreamBase* parent);
+    bool wait() const Q_DECL_OVERRIDE;
+    void cancel() Q_DECL_OVERRIDE;
+private:
+    void hold(const QVariant& value);
+    void onTimeout();
+    void flush();
+private:
+    const Mode m_mode;
+    QTimer* m_timer = nullptr;
+    QVariant m_latest;
+    bool m_hasLatest = false;
+};
+
+
+class Writer : public Operator {
+    Q_OBJECT
+public:
+    Writer(QIODevice* device, int bufferSize, int flushMs, qint64 maxPending, StreamBase* parent);
+    bool wait() const Q_DECL_OVERRIDE;
+    void cancel() Q_DECL_OVERRIDE;
+private:
+    void write(const QByteArray& data);
+    void flush();
+    void checkPending();
+    void onWritten();
+    void drain();
+private:
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    const int m_bufferSize;
+    const qint64 m_maxPending;
+    QTimer* m_timer = nullptr;
+    bool m_deferred = false;
+    bool m_draining = false;
+};
+
+
 class Scan : public Operator {
     Q_OBJECT
 public:
-    Scan(std::function<QVariant()> getAcc, std::function<void (const QVariant& variant)> scan, StreamBase* parent);
+    Scan(Callable<QVariant()> getAcc, Callable<void (const QVariant& variant)> scan, StreamBase* parent);
     bool wait() const Q_DECL_OVERRIDE;
     void cancel() Q_DECL_OVERRIDE;
 private:
@@ -103,9 +162,12 @@ class Each : public Operator {
     Q_OBJECT
 public:
     template<typename ...Args>
-    Each(std::function<void (const QVariant& variant)> each, StreamBase* parent) : Operator(parent) {
-        QObject::connect(m_parent, &StreamBase::next, this, [this, each](const QVariant & value) {
-            each(value);
+    Each(Callable<void (const QVariant& variant)> each, StreamBase* parent) : Operator(parent) {
+        QObject::connect(m_parent, &StreamBase::next, this, [this, each = std::move(each)](const QVariant & value) {
+            {
+                CallbackScope scope(this);
+                each(value);
+            }
             emit next(value);
         });
     }
@@ -118,7 +180,11 @@ public:
     template<typename ...Args>
     CompleteFilter(std::function<QVariant(const QVariant&)> filter, StreamBase* parent)  : Operator(parent) {
         QObject::connect(m_parent, &StreamBase::next,  this, [this, filter](const QVariant & value) {
-            const auto v = filter(value);
+            QVariant v;
+            {
+                CallbackScope scope(this);
+                v = filter(value);
+            }
             if(v.isValid() && v.toBool()) {
                 producer()->complete();
             } else {
@@ -128,13 +194,42 @@ public:
     }
 };
 
+/*
+ * Unlike CompleteFilter, Take stops the producer at once and drops whatever is still coming
+*/
+class Take : public Operator {
+    Q_OBJECT
+public:
+    Take(int count, std::function<bool (const QVariant&)> accept, StreamBase* parent);
+    void cancel() Q_DECL_OVERRIDE;
+private:
+    void stop();
+private:
+    const int m_count;
+    int m_taken = 0;
+    bool m_done = false;
+};
+
+class Skip : public Operator {
+    Q_OBJECT
+public:
+    Skip(int count, std::function<bool (const QVariant&)> skip, StreamBase* parent);
+private:
+    int m_count;
+    bool m_skipping = true;
+};
+
 class Buffer : public Operator {
     Q_OBJECT
 public:
-    Buffer(int max, StreamBase* parent);
+    Buffer(int max, qint64 spillBytes, StreamBase* parent);
     void cancel() Q_DECL_OVERRIDE;
+    qint64 queued() const Q_DECL_OVERRIDE;
+private:
+    void flush();
 private:
-    QVariantList m_buffer;
+    const qint64 m_spillBytes;
+    SpillList m_buffer;
 };
 
 
@@ -164,6 +259,20 @@ private:
     bool m_wait = true;
 };
 
+/*
+ * Records latency of values passing, see LatencyContext, into histograms shared by name.
+ */
+class LatencyProbe : public Operator {
+    Q_OBJECT
+public:
+    LatencyProbe(const QString& name, StreamBase* parent);
+    ~LatencyProbe() Q_DECL_OVERRIDE;
+    void appendStats(QVariantMap& stats) const Q_DECL_OVERRIDE;
+private:
+    const QString m_name;
+    const std::shared_ptr<LatencyHistograms> m_histograms;
+};
+
 }
 
 #endif // AXQ_OPERATORS_H
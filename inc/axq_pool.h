@@ -0,0 +1,24 @@
+#ifndef AXQ_POOL_H
+#define AXQ_POOL_H
+
+#include <cstddef>
+
+namespace Axq {
+
+/*
+ * Memory of stream nodes: small blocks are taken from per thread free lists by size class, that are
+ * refilled from large chunks, thus creating and deleting a pipeline does not call malloc or free.
+ * Block freed in other thread goes to that thread's lists. Chunks are kept for reuse, lists of
+ * an exited thread are given to the others.
+ */
+class NodePool {
+public:
+    static constexpr std::size_t ChunkSize = 0x10000;
+    static void* allocate(std::size_t size);
+    static void release(void* ptr, std::size_t size);
+    static std::size_t chunks();    //taken from heap so far
+};
+
+}
+
+#endif // AXQ_POOL_H
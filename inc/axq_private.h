@@ -20,12 +20,17 @@ namespace  Axq {
     class Owner : public QObject {
         Q_OBJECT
     public:
-        Owner(ProducerBase* p, std::function<void()> f) : QObject(p), m_onDelete(f){}
+        Owner(ProducerBase* p, std::function<void()> f) : QObject(p), m_onDelete(f){
+            m_accounted.begin(this);
+            m_accounted.classify(this, staticMetaObject.className());
+        }
         ~Owner(){
+            m_accounted.end(this);
             m_onDelete();
         }
     private:
         std::function<void()>  m_onDelete;
+        Accounted m_accounted;
     };
 }
 
@@ -1,13 +1,21 @@
 #ifndef AXQ_CORE_H
 #define AXQ_CORE_H
 
+#include <QFile>
+#include <QVector>
+#include <deque>
+#include <type_traits>
 #include "axq_streams.h"
+#include "axq_spill.h"
 
 namespace Axq {
 
 constexpr int RequestOne = -1;
 constexpr int DoDefer = -2;
 
+constexpr int OneLine = -1;
+constexpr int Slurp = 0;
+
 constexpr char StreamCancel[] = "Stream::Cancel";
 constexpr int StreamCancelValue = 1000;
 
@@ -55,11 +63,14 @@ public:
     QueueProducer(QObject* parent);
     QueueProducer(std::nullptr_t);
     bool wait() const Q_DECL_OVERRIDE;
+    std::shared_ptr<LatencyStamps> stamps() const {return m_stamps;}
 private:
     void init();
 signals:
     void push(const QVariant& value);
     void doComplete();
+private:
+    std::shared_ptr<LatencyStamps> m_stamps = std::make_shared<LatencyStamps>();  //shared with pushing side
 };
 
 class Serializer : public ProducerBase {
@@ -101,45 +112,61 @@ public:
 class FuncProducer : public Serializer {
     Q_OBJECT
 public:
-    FuncProducer(std::function<QVariant ()> function, std::nullptr_t parent);
-    FuncProducer(std::function<QVariant ()> function, QObject* parent);
-    FuncProducer(std::function<QVariant ()> function, StreamBase* parent);
+    FuncProducer(Callable<QVariant ()> function, std::nullptr_t parent);
+    FuncProducer(Callable<QVariant ()> function, QObject* parent);
+    FuncProducer(Callable<QVariant ()> function, StreamBase* parent);
     bool hasData() const Q_DECL_OVERRIDE;
     void request(int ms) Q_DECL_OVERRIDE;
-    void set(std::function<QVariant ()> function);
+    void set(Callable<QVariant ()> function);
     void cancel() Q_DECL_OVERRIDE;
 private:
     void onNext() Q_DECL_OVERRIDE;
 private:
-    std::function<QVariant ()> m_f = nullptr;
+    Callable<QVariant ()> m_f;
     bool m_called = false;
 };
 
-template <typename PARENT = StreamBase*>
+/*
+ * Outputs begin, begin + step... until end, or if blockSize > 0 QVector<T> of blockSize values.
+ * Values are computed from index to keep floating point steps exact and to not overflow at the end.
+ */
+template <typename T = int, typename PARENT = StreamBase*>
 class Range : public Serializer {
+    using Wide = typename std::conditional<std::is_floating_point<T>::value, double, qint64>::type;
 public:
-    Range(int begin, int end, int step, PARENT parent);
+    Range(T begin, T end, T step, int blockSize, PARENT parent);
+    Range(T begin, T end, T step, PARENT parent) : Range(begin, end, step, 0, parent) {}
     bool hasData() const Q_DECL_OVERRIDE {
-        return m_acc < m_end;
+        return inRange(m_index);
     }
     void cancel() Q_DECL_OVERRIDE {
-        m_acc = m_end;
+        m_cancelled = true;
         ProducerBase::cancel();
     }
 protected:
     void onNext() Q_DECL_OVERRIDE;
 private:
-    int m_acc;
-    const int m_end;
-    const int m_step;
+    Wide at(qint64 index) const {
+        return static_cast<Wide>(m_begin) + static_cast<Wide>(index) * static_cast<Wide>(m_step);
+    }
+    bool inRange(qint64 index) const {
+        return !m_cancelled && (m_step < 0 ? at(index) > m_end : at(index) < m_end);
+    }
+private:
+    const T m_begin;
+    const T m_end;
+    const T m_step;
+    const int m_blockSize;
+    qint64 m_index = 0;
+    bool m_cancelled = false;
 };
 
 
 //Range
 
-template <typename PARENT>
-Range<PARENT>::Range(int begin, int end, int step, PARENT parent) :
-    Serializer(parent), m_acc(begin), m_end(end), m_step(step){
+template <typename T, typename PARENT>
+Range<T, PARENT>::Range(T begin, T end, T step, int blockSize, PARENT parent) :
+    Serializer(parent), m_begin(begin), m_end(end), m_step(step), m_blockSize(blockSize){
     delayedCall([this](){
         if(!hasData()){
             complete();
@@ -147,25 +174,43 @@ Range<PARENT>::Range(int begin, int end, int step, PARENT parent) :
     });
 }
 
-template <typename PARENT>
-void Range<PARENT>::onNext(){
-    if(m_acc < m_end){
-        emit this->next(m_acc);
-        m_acc += m_step;
+template <typename T, typename PARENT>
+void Range<T, PARENT>::onNext(){
+    if(!inRange(m_index)){
+        return;
     }
+    if(m_blockSize <= 0){
+        emit this->next(QVariant::fromValue<T>(static_cast<T>(at(m_index++))));
+        return;
+    }
+    QVector<T> block;
+    block.reserve(m_blockSize);
+    while(block.size() < m_blockSize && inRange(m_index)){
+        block.append(static_cast<T>(at(m_index++)));
+    }
+    emit this->next(QVariant::fromValue<QVector<T>>(block));
 }
 
 
+template <typename CONTAINER, typename IT>
+void appendTo(CONTAINER& container, IT& it, const QVariant& item) {
+    const auto d = std::distance(container.constBegin(), it);
+    //we dunno if realloc happen, right?
+    container.append(item);
+    it = container.constBegin();
+    std::advance(it, d);
+}
+
 template <typename CONTAINER, typename PARENT = StreamBase*>
 class Container : public Serializer {
 public:
    Container(PARENT parent) : Serializer(parent){
        m_it = m_container.constBegin();
    }
-   Container(CONTAINER&& container, PARENT parent) : Serializer(parent), m_container(container), m_it(container.constBegin()){}
-   Container(const CONTAINER& container, PARENT parent) : Serializer(parent), m_container(container), m_it(container.constBegin()){}
+   Container(CONTAINER&& container, PARENT parent) : Serializer(parent), m_container(std::move(container)), m_it(m_container.constBegin()){}
+   Container(const CONTAINER& container, PARENT parent) : Serializer(parent), m_container(container), m_it(m_container.constBegin()){}
    void set(CONTAINER&& c) {
-       m_container = c;
+       m_container = std::move(c);
        m_it = m_container.constBegin();
    }
 
@@ -173,11 +218,10 @@ public:
        return !m_container.isEmpty();
    }
    void append(const QVariant& item){
-       const auto d = std::distance(m_container.constBegin(), m_it);
-       //we dunno if realloc happen, right?
-       m_container.append(item);
-       m_it = m_container.constBegin();
-       std::advance(m_it, d);
+       appendTo(m_container, m_it, item);
+   }
+   CONTAINER& container() {
+       return m_container;
    }
 
    void cancel() Q_DECL_OVERRIDE {
@@ -242,7 +286,7 @@ void Value<PARENT>::onNext(){
 class Repeater : public ProducerBase {
     Q_OBJECT
 public:
-    using RepeatFunction = std::function<QVariant ()>;
+    using RepeatFunction = Callable<QVariant ()>;
     Repeater(RepeatFunction f, int ms, StreamBase* parent);
     Repeater(RepeatFunction f, int ms, QObject* parent);
     Repeater(RepeatFunction f, int ms, std::nullptr_t);
@@ -273,7 +317,7 @@ public:
 private:
     void initConnections() Q_DECL_OVERRIDE {} // not using default handlers
 private:
-    Container<QVariantList>* m_container;
+    Container<SpillList>* m_container;
     bool m_pending = true;
 };
 
@@ -290,13 +334,36 @@ private:
     QSet<StreamBase*> m_sources;
 };
 
+/*
+ * Outputs views to the file mapping, no data is copied
+*/
+class MappedFile : public Serializer {
+    Q_OBJECT
+public:
+    MappedFile(QFile* file, uchar* data, qint64 size, int len, std::nullptr_t);
+    ~MappedFile() Q_DECL_OVERRIDE;
+    bool hasData() const Q_DECL_OVERRIDE;
+    void cancel() Q_DECL_OVERRIDE;
+protected:
+    void onNext() Q_DECL_OVERRIDE;
+private:
+    QFile* m_file;      //own handle, the mapping may outlive the file that is read
+    uchar* m_data;
+    qint64 m_size;
+    qint64 m_pos = 0;
+    std::deque<QByteArray> m_views; //emitted views that are still referenced
+    const int m_len;
+};
+
 template <class PARENT = StreamBase*>
 class Iterator : public Serializer {
 public:
-    Iterator(std::function<bool ()> hasNext, std::function<QVariant ()> next, std::function<void()> onEnd, PARENT parent)
-        : Serializer(parent), m_hasNext(hasNext), m_next(next), m_onEnd(onEnd){}
+    Iterator(Callable<bool ()> hasNext, Callable<QVariant ()> next, Callable<void()> onEnd, PARENT parent)
+        : Serializer(parent), m_hasNext(std::move(hasNext)), m_next(std::move(next)), m_onEnd(std::move(onEnd)){}
     ~Iterator() Q_DECL_OVERRIDE {
-        m_onEnd();
+        if(m_onEnd) {
+            m_onEnd();
+        }
     }
 protected:
     void onNext() Q_DECL_OVERRIDE {
@@ -314,9 +381,42 @@ protected:
         ProducerBase::cancel();
     }
 private:
-    std::function<bool ()> m_hasNext;
-    std::function<QVariant ()> m_next;
-    std::function<void ()> m_onEnd;
+    Callable<bool ()> m_hasNext;
+    Callable<QVariant ()> m_next;
+    Callable<void ()> m_onEnd;
+};
+
+/*
+ * Outputs at(0)..at(count - 1), the source knows its size and is accessed by index
+*/
+template <class PARENT = StreamBase*>
+class Indexed : public Serializer {
+public:
+    Indexed(qint64 count, Callable<QVariant (qint64)> at, PARENT parent)
+        : Serializer(parent), m_count(count), m_at(std::move(at)){
+        delayedCall([this](){
+            if(!hasData()){
+                complete();
+            }
+        });
+    }
+protected:
+    void onNext() Q_DECL_OVERRIDE {
+        if(m_index < m_count){
+            emit this->next(m_at(m_index++));
+        }
+    }
+    bool hasData() const Q_DECL_OVERRIDE {
+        return m_index < m_count;
+    }
+    void cancel() Q_DECL_OVERRIDE {
+        m_index = m_count;
+        ProducerBase::cancel();
+    }
+private:
+    const qint64 m_count;
+    qint64 m_index = 0;
+    Callable<QVariant (qint64)> m_at;
 };
 
 
@@ -36,6 +36,10 @@ public:
     Q_INVOKABLE QVariant meta(int info, const QJSValue& caller);
     Q_INVOKABLE QVariant iterate(const QJSValue& caller = QJSValue());
     Q_INVOKABLE QVariant delay(int ms);
+    Q_INVOKABLE QVariant debounce(int ms);
+    Q_INVOKABLE QVariant throttleFirst(int ms);
+    Q_INVOKABLE QVariant throttleLatest(int ms);
+    Q_INVOKABLE QVariant sample(int ms);
     Q_INVOKABLE QVariant buffer(const QJSValue& caller);
     Q_INVOKABLE QVariant buffer();
     Q_INVOKABLE QVariant onError(const QJSValue& caller);
@@ -55,6 +59,8 @@ public:
 protected:
     EnvQML* m_env = nullptr;
     StreamQML* m_parent = nullptr;
+private:
+    Accounted m_accounted;
 };
 
 class ProducerQML : public StreamQML {
@@ -195,6 +201,16 @@ private:
     StreamBase* m_delay = nullptr;
 };
 
+class ThrottleQML : public StreamQML {
+    Q_OBJECT
+public:
+    ThrottleQML(Throttle::Mode mode, int ms, EnvQML* env, StreamQML* parent);
+protected:
+    StreamBase* stream() Q_DECL_OVERRIDE;
+private:
+    StreamBase* m_throttle = nullptr;
+};
+
 class EnvQML : public QObject{
     Q_OBJECT
 public:
@@ -0,0 +1,66 @@
+#ifndef AXQ_SPILL_H
+#define AXQ_SPILL_H
+
+#include <memory>
+#include <iterator>
+#include <QVariant>
+
+namespace Axq {
+
+/**
+ * List of values that are kept in memory until their estimated size exceeds a given limit,
+ * then all values are encoded into a temporary file and read back via memory mapping.
+ * Copies share the data until modified. If the file cannot be written, values are moved
+ * back into memory and kept there, the failure is told by takeError.
+ */
+class SpillList {
+    struct Data;
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = QVariant;
+        using difference_type = qint64;
+        using pointer = const QVariant*;
+        using reference = QVariant;
+        const_iterator() {}
+        QVariant operator*() const;
+        const_iterator& operator++();
+        bool operator==(const const_iterator& other) const {return m_index == other.m_index;}
+        bool operator!=(const const_iterator& other) const {return m_index != other.m_index;}
+    private:
+        friend class SpillList;
+        const_iterator(Data* data, qint64 index, int generation) : m_data(data), m_index(index), m_generation(generation) {}
+        void seek() const;
+    private:
+        Data* m_data = nullptr;
+        qint64 m_index = 0;
+        mutable qint64 m_offset = 0;
+        mutable qint64 m_next = -1;     //offset of next, when current is decoded
+        mutable int m_generation = -1;  //offset is valid only if data is not spilled meanwhile
+    };
+    SpillList(qint64 spillBytes = 0);
+    SpillList(const QVariantList& list);
+    void append(const QVariant& value);
+    bool isEmpty() const;
+    qint64 size() const;
+    bool isSpilled() const;
+    void clear();
+    const_iterator constBegin() const;
+    const_iterator constEnd() const;
+    const_iterator rebind(const const_iterator& it) const;
+    QVariantList toList() const;
+    QString takeError();    //failure since previous call, empty if none
+private:
+    void detach();
+private:
+    std::shared_ptr<Data> d;
+};
+
+void appendTo(SpillList& list, SpillList::const_iterator& it, const QVariant& value);
+
+}
+
+Q_DECLARE_METATYPE(Axq::SpillList)
+
+#endif // AXQ_SPILL_H
@@ -2,11 +2,19 @@
 #define REACTQUTION_PRIVATE_H
 
 #include <functional>
+#include <memory>
 #include <QTimer>
 #include <QVariant>
 #include <QMetaMethod>
 #include <QEvent>
 #include <QSet>
+#include <QElapsedTimer>
+#include "axq_metrics.h"
+#include "axq_trace.h"
+#include "axq_accounting.h"
+#include "axq_latency.h"
+#include "axq_pool.h"
+#include "axq_callable.h"
 
 #define PADDING4 const int s_padding = 0;
 
@@ -132,11 +140,19 @@ public:
     StreamBase(StreamBase* parent);
     StreamBase(QObject* parent);
     virtual ~StreamBase() Q_DECL_OVERRIDE;
+#ifndef AXQ_NO_NODE_POOL   //define to get nodes from plain heap, e.g. for memory checkers
+    static void* operator new(std::size_t size) {return NodePool::allocate(size);}
+    static void operator delete(void* ptr, std::size_t size) {NodePool::release(ptr, size);}
+#endif
     virtual ProducerBase* producer();
     virtual bool isAlias(const QObject* item) const;     //tell if item is this, or if this has some childs
     virtual bool wait() const;                                   //tell is this is pending and complete cannot requested yet, but this may happend soon and then waitOver should be emitted
     virtual void cancel();                                  //upon cancel, default does nothing
+    virtual qint64 queued() const;                          //number of values held, for statistics
+    virtual void appendStats(QVariantMap& stats) const;     //stream specific statistics, default has none
     bool hasParent() const {return m_parent; }
+    StreamBase* parentStream() const {return m_parent;}
+    Metrics* metrics() const {return m_metrics.get();}      //null unless enabled
     ProducerBase* root();
     void addChildren(StreamBase*  stream);
     void removeChildren(StreamBase* stream);
@@ -151,6 +167,7 @@ protected:
     virtual void connectFinished();
 protected:
      void childEvent(QChildEvent *event) Q_DECL_OVERRIDE;
+     bool event(QEvent* event) Q_DECL_OVERRIDE;
 signals:
     void next(const QVariant& next);
     void error(const Error& error);
@@ -162,6 +179,9 @@ private:
     void connectBaseHandlers();
     template<class T> void getAllChildren(QList<T*>&) const;
     QSet<StreamBase*> m_children;
+    std::unique_ptr<Metrics> m_metrics;
+    Accounted m_accounted;
+    friend class Metrics;
 };
 
 
@@ -186,6 +206,31 @@ inline void StreamBase::getAllChildren(QList<T*>& lst) const {
 
 
 
+/*
+ * Wraps a user callback of a stream, measures it if metrics are enabled and traces it if tracing is on
+ */
+class CallbackScope {
+public:
+    CallbackScope(const StreamBase* stream) : m_metrics(stream->metrics()), m_trace("callback", stream) {
+        if(m_metrics) {
+            m_timer.start();
+        }
+    }
+    ~CallbackScope() {
+        if(m_metrics) {
+            Metrics::add(m_metrics->callbacks);
+            Metrics::add(m_metrics->callbackNs, static_cast<quint64>(m_timer.nsecsElapsed()));
+        }
+    }
+    CallbackScope(const CallbackScope&) = delete;
+    CallbackScope& operator=(const CallbackScope&) = delete;
+private:
+    Metrics* m_metrics;
+    TraceScope m_trace;
+    QElapsedTimer m_timer;
+};
+
+
 class ParentStream : public StreamBase {
     Q_OBJECT
 public:
@@ -5,6 +5,8 @@
 #include <memory>
 #include <QThreadPool>
 #include <QSet>
+#include <QQueue>
+#include <QThread>
 #include "axq_producer.h"
 #include "axq_operators.h"
 
@@ -60,6 +62,53 @@ private:
     QThread m_thread;
 };
 
+class ReadAhead : public QObject {
+    Q_OBJECT
+public:
+    ReadAhead(QIODevice* device, const QString& path, int chunkSize, int depth);
+public slots:
+    void start();
+    void release(int slot);
+signals:
+    void chunk(int slot, const QByteArray& data);
+    void ended(const QString& error);
+private:
+    void fill();
+    void end(const QString& error);
+private:
+    QIODevice* m_device;
+    const QString m_path;
+    const int m_chunkSize;
+    QVector<QByteArray> m_ring;
+    QList<int> m_free;
+    bool m_channelFinished = false;
+    bool m_ended = false;
+};
+
+class AsyncRead : public Serializer {
+    Q_OBJECT
+public:
+    AsyncRead(ReadAhead* reader, std::nullptr_t);
+    ~AsyncRead() Q_DECL_OVERRIDE;
+    bool hasData() const Q_DECL_OVERRIDE;
+    qint64 queued() const Q_DECL_OVERRIDE;
+    void request(int milliseconds) Q_DECL_OVERRIDE;
+    void defer() Q_DECL_OVERRIDE;
+    void cancel() Q_DECL_OVERRIDE;
+signals:
+    void release(int slot);
+protected:
+    void onNext() Q_DECL_OVERRIDE;
+private:
+    void resume();
+private:
+    QThread m_thread;
+    QQueue<QPair<int, QByteArray>> m_ready;
+    bool m_ended = false;
+    bool m_starved = false;
+    int m_pace = 0;
+};
+
 }
 
 #endif
@@ -0,0 +1,56 @@
+#ifndef AXQ_TRACE_H
+#define AXQ_TRACE_H
+
+#include <atomic>
+#include <QByteArray>
+
+class QObject;
+
+namespace Axq {
+
+/*
+ * Records stream events into per thread buffers, that are written only by their own thread,
+ * and exports them as Chrome Trace Event JSON. Nothing is recorded unless started.
+ */
+class Trace {
+public:
+    enum Phase : char {Begin = 'B', End = 'E', Instant = 'i'};
+    static bool enabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    static void start();
+    static void stop();
+    static QByteArray json();
+    static void record(Phase phase, const char* name, const QObject* stream);
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class TraceScope {
+public:
+    TraceScope(const char* name, const QObject* stream) : m_name(Trace::enabled() ? name : nullptr), m_stream(stream) {
+        if(m_name) {
+            Trace::record(Trace::Begin, m_name, m_stream);
+        }
+    }
+    ~TraceScope() {
+        if(m_name) {
+            Trace::record(Trace::End, m_name, m_stream);
+        }
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+private:
+    const char* m_name;
+    const QObject* m_stream;
+};
+
+inline void traceInstant(const char* name, const QObject* stream) {
+    if(Trace::enabled()) {
+        Trace::record(Trace::Instant, name, stream);
+    }
+}
+
+}
+
+#endif // AXQ_TRACE_H
@@ -5,7 +5,7 @@
 #-------------------------------------------------
 
 QT       -= gui
-QT       += quick concurrent
+QT       += quick concurrent network
 
 TARGET = Axq
 TEMPLATE = lib
@@ -16,17 +16,30 @@ else: message(Static build)
 
 DEFINES += QT_DEPRECATED_WARNINGS
 DEFINES += AXQSHAREDLIB_LIBRARY
+nopool: DEFINES += AXQ_NO_NODE_POOL #nodes from plain heap, e.g. for memory checkers
 
 INCLUDEPATH +=  .. ../inc
 
 HEADERS +=                      \
     ../axq.h                    \
+    ../axq_callable.h           \
+    ../axq_codec.h              \
     ../inc/axq_qml.h            \
     ../inc/axq_streams.h        \
     ../inc/axq_producer.h       \
     ../inc/axq_operators.h      \
     ../inc/axq_private.h \
-    ../inc/axq_threads.h
+    ../inc/axq_threads.h \
+    ../inc/axq_lines.h \
+    ../inc/axq_localsocket.h \
+    ../inc/axq_spill.h \
+    ../inc/axq_journal.h \
+    ../inc/axq_metrics.h \
+    ../inc/axq_trace.h \
+    ../inc/axq_graph.h \
+    ../inc/axq_accounting.h \
+    ../inc/axq_latency.h \
+    ../inc/axq_pool.h
 
 SOURCES +=                      \
     ../src/axq_qml.cpp          \
@@ -35,7 +48,18 @@ SOURCES +=                      \
     ../src/axq_producers.cpp    \
     ../src/axq_operators.cpp    \
     ../src/axq_threads.cpp      \
-    ../src/axq_private.cpp
+    ../src/axq_private.cpp      \
+    ../src/axq_lines.cpp        \
+    ../src/axq_localsocket.cpp  \
+    ../src/axq_codec.cpp        \
+    ../src/axq_spill.cpp \
+    ../src/axq_journal.cpp \
+    ../src/axq_metrics.cpp \
+    ../src/axq_trace.cpp \
+    ../src/axq_graph.cpp \
+    ../src/axq_accounting.cpp \
+    ../src/axq_latency.cpp \
+    ../src/axq_pool.cpp
 
 
 unix {
@@ -0,0 +1,211 @@
+#include "axq_accounting.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+
+#if defined(__GLIBC__) || defined(Q_OS_MACOS)
+#include <execinfo.h>
+#include <cstdlib>
+#define AXQ_BACKTRACE
+#endif
+
+using namespace Axq;
+
+namespace {
+
+constexpr int Frames = 24;
+
+struct Count {
+    quint64 created = 0;
+    quint64 destroyed = 0;
+};
+
+/*
+ * Written by its own thread, the mutex is only contended when a report is read.
+ * Counters are never freed so that the counts of finished threads remain.
+ */
+struct ThreadCounters {
+    QMutex mutex;
+    QHash<const char*, Count> counts; //class names are static strings
+    QString name;
+};
+
+struct Sample {
+    const char* kind = nullptr;
+    qint64 ns = 0;
+    QString thread;
+    void* frames[Frames];
+    int depth = 0;
+};
+
+std::atomic<int> sampleInterval{0};
+QMutex countersMutex;
+std::vector<std::unique_ptr<ThreadCounters>> counters;
+thread_local ThreadCounters* localCounters = nullptr;
+thread_local unsigned localCreated = 0;
+QMutex samplesMutex;
+QHash<const QObject*, Sample> samples;  //live sampled objects
+
+qint64 now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QString threadName() {
+    const auto thread = QThread::currentThread();
+    if(!thread->objectName().isEmpty()) {
+        return thread->objectName();
+    }
+    if(QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        return QStringLiteral("main");
+    }
+    return QString("0x%1").arg(reinterpret_cast<quintptr>(thread), 0, 16);
+}
+
+ThreadCounters* threadCounters() {
+    if(!localCounters) {
+        auto c = new ThreadCounters();
+        c->name = threadName();
+        QMutexLocker lock(&countersMutex);
+        counters.emplace_back(c);
+        localCounters = c;
+    }
+    return localCounters;
+}
+
+QVariantMap toMap(const QHash<QByteArray, Count>& counts) {
+    QVariantMap map;
+    for(auto it = counts.begin(); it != counts.end(); ++it) {
+        map.insert(QString::fromLatin1(it.key()), QVariantMap{
+            {"created", it.value().created},
+            {"destroyed", it.value().destroyed},
+            {"live", static_cast<qint64>(it.value().created - it.value().destroyed)}});
+    }
+    return map;
+}
+
+QVariantList symbols(const Sample& sample) {
+    QVariantList list;
+#ifdef AXQ_BACKTRACE
+    const auto names = ::backtrace_symbols(sample.frames, sample.depth);
+    if(names) {
+        for(int i = 0; i < sample.depth; i++) {
+            list.append(QString::fromLocal8Bit(names[i]));
+        }
+        std::free(names);
+    }
+#else
+    for(int i = 0; i < sample.depth; i++) {
+        list.append(QString("0x%1").arg(reinterpret_cast<quintptr>(sample.frames[i]), 0, 16));
+    }
+#endif
+    return list;
+}
+
+// AXQ_ACCOUNTING=<sample interval> turns accounting on without code changes
+void initAccounting() {
+    if(qEnvironmentVariableIsSet("AXQ_ACCOUNTING")) {
+        Accounting::setEnabled(true, qEnvironmentVariableIntValue("AXQ_ACCOUNTING"));
+    }
+}
+
+}
+
+Q_CONSTRUCTOR_FUNCTION(initAccounting)
+
+std::atomic<bool> Accounting::s_enabled{false};
+
+void Accounting::setEnabled(bool enabled, int interval) {
+    sampleInterval.store(std::max(0, interval), std::memory_order_relaxed);
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Accounting::sample() {
+    const auto interval = sampleInterval.load(std::memory_order_relaxed);
+    return interval > 0 && ++localCreated % static_cast<unsigned>(interval) == 0;
+}
+
+void Accounting::track(const QObject* object) {
+    Sample sample;
+    sample.ns = now();
+    sample.thread = threadName();
+#ifdef AXQ_BACKTRACE
+    sample.depth = ::backtrace(sample.frames, Frames);
+#endif
+    QMutexLocker lock(&samplesMutex);
+    samples.insert(object, sample);
+}
+
+void Accounting::untrack(const QObject* object) {
+    QMutexLocker lock(&samplesMutex);
+    samples.remove(object);
+}
+
+void Accounting::classify(const QObject* object, const char* kind, bool sampled) {
+    count(kind, true);
+    if(sampled) {
+        QMutexLocker lock(&samplesMutex);
+        const auto it = samples.find(object);
+        if(it != samples.end()) {
+            it->kind = kind;
+        }
+    }
+}
+
+void Accounting::count(const char* kind, bool created) {
+    const auto c = threadCounters();
+    QMutexLocker lock(&c->mutex);
+    auto& count = c->counts[kind];
+    if(created) {
+        ++count.created;
+    } else {
+        ++count.destroyed;
+    }
+}
+
+QVariantMap Accounting::report() {
+    QHash<QByteArray, Count> total;
+    QVariantList threads;
+    {
+        QMutexLocker lock(&countersMutex);
+        for(const auto& c : counters) {
+            QHash<QByteArray, Count> counts;
+            {
+                QMutexLocker threadLock(&c->mutex);
+                for(auto it = c->counts.begin(); it != c->counts.end(); ++it) {
+                    counts[it.key()] = it.value();
+                }
+            }
+            for(auto it = counts.begin(); it != counts.end(); ++it) {
+                auto& t = total[it.key()];
+                t.created += it.value().created;
+                t.destroyed += it.value().destroyed;
+            }
+            threads.append(QVariantMap{{"thread", c->name}, {"classes", toMap(counts)}});
+        }
+    }
+    QVariantList live;
+    const auto current = now();
+    {
+        QMutexLocker lock(&samplesMutex);
+        for(auto it = samples.begin(); it != samples.end(); ++it) {
+            live.append(QVariantMap{
+                {"id", QString("0x%1").arg(reinterpret_cast<quintptr>(it.key()), 0, 16)},
+                {"type", it->kind ? QString::fromLatin1(it->kind) : QStringLiteral("unclassified")},
+                {"ageMs", (current - it->ns) / 1000000},
+                {"thread", it->thread},
+                {"stack", symbols(*it)}});
+        }
+    }
+    QVariantMap map;
+    map.insert("enabled", enabled());
+    map.insert("sampleInterval", sampleInterval.load(std::memory_order_relaxed));
+    map.insert("classes", toMap(total));
+    map.insert("threads", threads);
+    map.insert("samples", live);
+    return map;
+}
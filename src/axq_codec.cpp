@@ -0,0 +1,574 @@
+#include "axq_codec.h"
+#include <cstring>
+#include <QDataStream>
+#include <QReadWriteLock>
+#include <QHash>
+#include <QStringList>
+#include <QtEndian>
+
+using namespace Axq;
+
+namespace {
+
+enum Tag : quint8 {
+    NullTag, FalseTag, TrueTag,
+    IntTag, UIntTag, LongLongTag, ULongLongTag, LongTag, ULongTag,
+    DoubleTag, FloatTag,
+    Latin1Tag, Utf16Tag, ByteArrayTag,
+    ListTag, StringListTag, MapTag, HashTag,
+    IntBatchTag, DoubleBatchTag,
+    CustomTag, StreamTag
+};
+
+constexpr char Magic[] = {'A', 'X', 'Q', 'C'};
+constexpr int BatchMin = 4;
+
+struct Registry {
+    QReadWriteLock lock;
+    QHash<int, QPair<Codec::Encoder, Codec::Decoder>> codecs;
+};
+
+Q_GLOBAL_STATIC(Registry, registry)
+QAtomicInt registered;
+
+template <typename T>
+const T& at(const QVariant& value) {
+    return *static_cast<const T*>(value.constData());
+}
+
+inline quint64 zigzag(qint64 value) {
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+inline qint64 unzigzag(quint64 value) {
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+inline void putTag(QByteArray& out, Tag tag) {
+    out.append(static_cast<char>(tag));
+}
+
+void putDouble(QByteArray& out, double value) {
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto pos = out.size();
+    out.resize(pos + 8);
+    qToLittleEndian<quint64>(bits, out.data() + pos);
+}
+
+bool getDouble(const char*& pos, const char* end, double& value) {
+    if(end - pos < 8) {
+        return false;
+    }
+    const auto bits = qFromLittleEndian<quint64>(pos);
+    std::memcpy(&value, &bits, sizeof(value));
+    pos += 8;
+    return true;
+}
+
+bool getSize(const char*& pos, const char* end, int& size) {
+    quint64 value;
+    if(!Codec::getVarint(pos, end, value) || value > static_cast<quint64>(end - pos)) {
+        return false; //nothing fits into remaining data
+    }
+    size = static_cast<int>(value);
+    return true;
+}
+
+void putString(QByteArray& out, const QString& string) {
+    const auto size = string.size();
+    const auto data = string.utf16();
+    int i = 0;
+    while(i < size && data[i] < 0x100) {
+        ++i;
+    }
+    if(i == size) {
+        putTag(out, Latin1Tag);
+        Codec::putVarint(out, static_cast<quint64>(size));
+        const auto pos = out.size();
+        out.resize(pos + size);
+        auto dst = out.data() + pos;
+        for(int c = 0; c < size; c++) {
+            dst[c] = static_cast<char>(data[c]);
+        }
+    } else {
+        putTag(out, Utf16Tag);
+        Codec::putVarint(out, static_cast<quint64>(size));
+        const auto pos = out.size();
+        out.resize(pos + size * 2);
+        qToLittleEndian<quint16>(data, size, out.data() + pos);
+    }
+}
+
+bool getString(const char*& pos, const char* end, QString& string) {
+    if(pos >= end) {
+        return false;
+    }
+    const auto tag = static_cast<quint8>(*pos++);
+    int size;
+    if(!getSize(pos, end, size)) {
+        return false;
+    }
+    if(tag == Latin1Tag) {
+        string = QString::fromLatin1(pos, size);
+        pos += size;
+        return true;
+    }
+    if(tag == Utf16Tag && size <= (end - pos) / 2) {
+        string = QString(size, Qt::Uninitialized);
+        qFromLittleEndian<quint16>(pos, size, string.data());
+        pos += size * 2;
+        return true;
+    }
+    return false;
+}
+
+bool encodeValue(const QVariant& value, QByteArray& out);
+
+bool encodeBatch(const QVariantList& list, QByteArray& out) {
+    const auto type = list.first().userType();
+    if((type != QMetaType::Int && type != QMetaType::Double) || list.size() < BatchMin) {
+        return false;
+    }
+    for(const auto& v : list) {
+        if(v.userType() != type) {
+            return false;
+        }
+    }
+    if(type == QMetaType::Int) {
+        putTag(out, IntBatchTag);
+        Codec::putVarint(out, static_cast<quint64>(list.size()));
+        for(const auto& v : list) {
+            Codec::putVarint(out, zigzag(at<int>(v)));
+        }
+    } else {
+        putTag(out, DoubleBatchTag);
+        Codec::putVarint(out, static_cast<quint64>(list.size()));
+        for(const auto& v : list) {
+            putDouble(out, at<double>(v));
+        }
+    }
+    return true;
+}
+
+bool encodeList(const QVariantList& list, QByteArray& out) {
+    if(!list.isEmpty() && encodeBatch(list, out)) {
+        return true;
+    }
+    putTag(out, ListTag);
+    Codec::putVarint(out, static_cast<quint64>(list.size()));
+    for(const auto& v : list) {
+        if(!encodeValue(v, out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename M>
+bool encodeMap(Tag tag, const M& map, QByteArray& out) {
+    putTag(out, tag);
+    Codec::putVarint(out, static_cast<quint64>(map.size()));
+    for(auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        putString(out, it.key());
+        if(!encodeValue(it.value(), out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// tag, type name, quint32 length and then payload, so the length can be written afterwards
+int beginLengthPrefixed(QByteArray& out, Tag tag, const char* typeName) {
+    putTag(out, tag);
+    if(typeName) {
+        const auto len = static_cast<int>(std::strlen(typeName));
+        Codec::putVarint(out, static_cast<quint64>(len));
+        out.append(typeName, len);
+    }
+    const auto pos = out.size();
+    out.resize(pos + 4);
+    return pos;
+}
+
+void endLengthPrefixed(QByteArray& out, int pos) {
+    qToLittleEndian<quint32>(static_cast<quint32>(out.size() - pos - 4), out.data() + pos);
+}
+
+bool getLengthPrefixed(const char*& pos, const char* end, int& size) {
+    if(end - pos < 4) {
+        return false;
+    }
+    const auto len = qFromLittleEndian<quint32>(pos);
+    pos += 4;
+    if(len > static_cast<quint32>(end - pos)) {
+        return false;
+    }
+    size = static_cast<int>(len);
+    return true;
+}
+
+bool encodeCustom(const QVariant& value, QByteArray& out, bool& found) {
+    found = false;
+    if(registered.loadRelaxed() == 0) {
+        return false;
+    }
+    Codec::Encoder encoder;
+    {
+        QReadLocker locker(&registry->lock);
+        const auto it = registry->codecs.constFind(value.userType());
+        if(it == registry->codecs.constEnd()) {
+            return false;
+        }
+        encoder = it->first;
+    }
+    found = true;
+    const auto mark = out.size();
+    const auto pos = beginLengthPrefixed(out, CustomTag, QMetaType::typeName(value.userType()));
+    if(!encoder(value, out)) {
+        out.resize(mark);
+        return false;
+    }
+    endLengthPrefixed(out, pos);
+    return true;
+}
+
+bool encodeStream(const QVariant& value, QByteArray& out) {
+    //QVariant::save only asserts on a type without stream operators, the status stays Ok
+    if(value.userType() >= QMetaType::User && !QMetaType::hasRegisteredStreamOperators(value.userType())) {
+        return false;
+    }
+    const auto mark = out.size();
+    const auto pos = beginLengthPrefixed(out, StreamTag, nullptr);
+    {
+        QDataStream stream(&out, QIODevice::WriteOnly | QIODevice::Append);
+        stream.setVersion(QDataStream::Qt_5_12);
+        stream << value;
+        if(stream.status() != QDataStream::Ok) {
+            out.resize(mark);
+            return false;
+        }
+    }
+    endLengthPrefixed(out, pos);
+    return true;
+}
+
+bool encodeValue(const QVariant& value, QByteArray& out) {
+    switch(value.userType()) {
+    case QMetaType::UnknownType:
+        putTag(out, NullTag);
+        return true;
+    case QMetaType::Bool:
+        putTag(out, at<bool>(value) ? TrueTag : FalseTag);
+        return true;
+    case QMetaType::Int:
+        putTag(out, IntTag);
+        Codec::putVarint(out, zigzag(at<int>(value)));
+        return true;
+    case QMetaType::UInt:
+        putTag(out, UIntTag);
+        Codec::putVarint(out, at<uint>(value));
+        return true;
+    case QMetaType::LongLong:
+        putTag(out, LongLongTag);
+        Codec::putVarint(out, zigzag(at<qlonglong>(value)));
+        return true;
+    case QMetaType::ULongLong:
+        putTag(out, ULongLongTag);
+        Codec::putVarint(out, at<qulonglong>(value));
+        return true;
+    case QMetaType::Long:
+        putTag(out, LongTag);
+        Codec::putVarint(out, zigzag(at<long>(value)));
+        return true;
+    case QMetaType::ULong:
+        putTag(out, ULongTag);
+        Codec::putVarint(out, at<ulong>(value));
+        return true;
+    case QMetaType::Double:
+        putTag(out, DoubleTag);
+        putDouble(out, at<double>(value));
+        return true;
+    case QMetaType::Float:
+        putTag(out, FloatTag);
+        putDouble(out, static_cast<double>(at<float>(value)));
+        return true;
+    case QMetaType::QString:
+        putString(out, at<QString>(value));
+        return true;
+    case QMetaType::QByteArray: {
+        const auto& bytes = at<QByteArray>(value);
+        putTag(out, ByteArrayTag);
+        Codec::putVarint(out, static_cast<quint64>(bytes.size()));
+        out.append(bytes);
+        return true;
+    }
+    case QMetaType::QStringList: {
+        const auto& list = at<QStringList>(value);
+        putTag(out, StringListTag);
+        Codec::putVarint(out, static_cast<quint64>(list.size()));
+        for(const auto& s : list) {
+            putString(out, s);
+        }
+        return true;
+    }
+    case QMetaType::QVariantList:
+        return encodeList(at<QVariantList>(value), out);
+    case QMetaType::QVariantMap:
+        return encodeMap(MapTag, at<QVariantMap>(value), out);
+    case QMetaType::QVariantHash:
+        return encodeMap(HashTag, at<QVariantHash>(value), out);
+    default: {
+        bool found;
+        const auto ok = encodeCustom(value, out, found);
+        return found ? ok : encodeStream(value, out);
+    }
+    }
+}
+
+template <typename M>
+bool decodeMap(const char*& pos, const char* end, QVariant& value) {
+    int count;
+    if(!getSize(pos, end, count)) {
+        return false;
+    }
+    M map;
+    for(int i = 0; i < count; i++) {
+        QString key;
+        QVariant item;
+        if(!getString(pos, end, key) || !Codec::decode(pos, end, item)) {
+            return false;
+        }
+        map.insert(key, item);
+    }
+    value = map;
+    return true;
+}
+
+bool decodeCustom(const char*& pos, const char* end, QVariant& value) {
+    int nameSize;
+    if(!getSize(pos, end, nameSize)) {
+        return false;
+    }
+    const QByteArray name(pos, nameSize);
+    pos += nameSize;
+    int size;
+    if(!getLengthPrefixed(pos, end, size)) {
+        return false;
+    }
+    Codec::Decoder decoder;
+    {
+        QReadLocker locker(&registry->lock);
+        const auto it = registry->codecs.constFind(QMetaType::type(name.constData()));
+        if(it == registry->codecs.constEnd()) {
+            return false;
+        }
+        decoder = it->second;
+    }
+    auto p = pos;
+    pos += size;
+    return decoder(p, pos, value) && p == pos;
+}
+
+}
+
+void Codec::putVarint(QByteArray& out, quint64 value) {
+    char buffer[10];
+    int len = 0;
+    while(value >= 0x80) {
+        buffer[len++] = static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    buffer[len++] = static_cast<char>(value);
+    out.append(buffer, len);
+}
+
+bool Codec::getVarint(const char*& pos, const char* end, quint64& value) {
+    value = 0;
+    for(int shift = 0; pos < end && shift < 64; shift += 7) {
+        const auto byte = static_cast<quint8>(*pos++);
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Codec::encode(const QVariant& value, QByteArray& out) {
+    const auto mark = out.size();
+    if(encodeValue(value, out)) {
+        return true;
+    }
+    out.resize(mark);
+    return false;
+}
+
+QVariant Codec::decode(const QByteArray& bytes) {
+    auto pos = bytes.constData();
+    QVariant value;
+    return decode(pos, pos + bytes.size(), value) ? value : QVariant();
+}
+
+bool Codec::decode(const char*& pos, const char* end, QVariant& value) {
+    if(pos >= end) {
+        return false;
+    }
+    const auto tag = static_cast<quint8>(*pos);
+    quint64 v;
+    switch(tag) {
+    case NullTag:
+        ++pos;
+        value = QVariant();
+        return true;
+    case FalseTag:
+    case TrueTag:
+        ++pos;
+        value = QVariant(tag == TrueTag);
+        return true;
+    case IntTag:
+    case UIntTag:
+    case LongLongTag:
+    case ULongLongTag:
+    case LongTag:
+    case ULongTag:
+        if(!getVarint(++pos, end, v)) {
+            return false;
+        }
+        switch(tag) {
+        case IntTag: value = QVariant(static_cast<int>(unzigzag(v))); break;
+        case UIntTag: value = QVariant(static_cast<uint>(v)); break;
+        case LongLongTag: value = QVariant(static_cast<qlonglong>(unzigzag(v))); break;
+        case ULongLongTag: value = QVariant(static_cast<qulonglong>(v)); break;
+        case LongTag: value = QVariant::fromValue(static_cast<long>(unzigzag(v))); break;
+        default: value = QVariant::fromValue(static_cast<ulong>(v)); break;
+        }
+        return true;
+    case DoubleTag:
+    case FloatTag: {
+        double d;
+        if(!getDouble(++pos, end, d)) {
+            return false;
+        }
+        value = tag == DoubleTag ? QVariant(d) : QVariant(static_cast<float>(d));
+        return true;
+    }
+    case Latin1Tag:
+    case Utf16Tag: {
+        QString string;
+        if(!getString(pos, end, string)) {
+            return false;
+        }
+        value = string;
+        return true;
+    }
+    case ByteArrayTag: {
+        int size;
+        if(!getSize(++pos, end, size)) {
+            return false;
+        }
+        value = QByteArray(pos, size);
+        pos += size;
+        return true;
+    }
+    case StringListTag: {
+        int count;
+        if(!getSize(++pos, end, count)) {
+            return false;
+        }
+        QStringList list;
+        list.reserve(count);
+        for(int i = 0; i < count; i++) {
+            QString string;
+            if(!getString(pos, end, string)) {
+                return false;
+            }
+            list.append(string);
+        }
+        value = list;
+        return true;
+    }
+    case ListTag: {
+        int count;
+        if(!getSize(++pos, end, count)) {
+            return false;
+        }
+        QVariantList list;
+        list.reserve(count);
+        for(int i = 0; i < count; i++) {
+            QVariant item;
+            if(!decode(pos, end, item)) {
+                return false;
+            }
+            list.append(item);
+        }
+        value = list;
+        return true;
+    }
+    case IntBatchTag:
+    case DoubleBatchTag: {
+        int count;
+        if(!getSize(++pos, end, count)) {
+            return false;
+        }
+        QVariantList list;
+        list.reserve(count);
+        for(int i = 0; i < count; i++) {
+            if(tag == IntBatchTag) {
+                if(!getVarint(pos, end, v)) {
+                    return false;
+                }
+                list.append(static_cast<int>(unzigzag(v)));
+            } else {
+                double d;
+                if(!getDouble(pos, end, d)) {
+                    return false;
+                }
+                list.append(d);
+            }
+        }
+        value = list;
+        return true;
+    }
+    case MapTag:
+        return decodeMap<QVariantMap>(++pos, end, value);
+    case HashTag:
+        return decodeMap<QVariantHash>(++pos, end, value);
+    case CustomTag:
+        return decodeCustom(++pos, end, value);
+    case StreamTag: {
+        int size;
+        if(!getLengthPrefixed(++pos, end, size)) {
+            return false;
+        }
+        QDataStream stream(QByteArray::fromRawData(pos, size));
+        stream.setVersion(QDataStream::Qt_5_12);
+        stream >> value;
+        pos += size;
+        return stream.status() == QDataStream::Ok;
+    }
+    default:
+        return false;
+    }
+}
+
+void Codec::registerType(int metaTypeId, Encoder encoder, Decoder decoder) {
+    Q_ASSERT(encoder && decoder);
+    QWriteLocker locker(&registry->lock);
+    registry->codecs.insert(metaTypeId, qMakePair(encoder, decoder));
+    registered.storeRelaxed(1);
+}
+
+void Codec::header(QByteArray& out) {
+    out.append(Magic, sizeof(Magic));
+    out.append(static_cast<char>(Version));
+}
+
+bool Codec::checkHeader(const char*& pos, const char* end) {
+    if(end - pos < HeaderSize || std::memcmp(pos, Magic, sizeof(Magic)) != 0
+            || static_cast<quint8>(pos[sizeof(Magic)]) > Version) {
+        return false;
+    }
+    pos += HeaderSize;
+    return true;
+}
@@ -3,6 +3,11 @@
 #include "axq_operators.h"
 #include "axq_threads.h"
 #include "axq_private.h"
+#include "axq_lines.h"
+#include "axq_localsocket.h"
+#include "axq_journal.h"
+#include "axq_graph.h"
+#include "axq_codec.h"
 
 
 using namespace Axq;
@@ -19,6 +24,21 @@ constexpr bool equal(char const* a, char const* b) {
 static_assert(equal(Axq::Stream::StreamCancel, Axq::StreamCancel), "mismatch");
 static_assert(Axq::Stream::StreamCancelValue == Axq::StreamCancelValue, "mismatch");
 static_assert(Axq::Stream::RequestOne == Axq::RequestOne, "mismatch");
+static_assert(Axq::Stream::OneLine == Axq::OneLine, "mismatch");
+static_assert(Axq::Stream::Slurp == Axq::Slurp, "mismatch");
+
+static void registerTuple() {
+    qRegisterMetaType<Axq::Tuple>();
+    QMetaType::registerConverter<Axq::Tuple, QVariantList>(&Axq::Tuple::toList);
+    //the element types are not known when decoding, thus a Tuple is read back as QVariantList
+    Codec::registerType(qMetaTypeId<Axq::Tuple>(), [](const QVariant & value, QByteArray & out) {
+        return Codec::encode(static_cast<const Axq::Tuple*>(value.constData())->toList(), out);
+    }, [](const char*& pos, const char* end, QVariant & value) {
+        return Codec::decode(pos, end, value);
+    });
+}
+
+Q_CONSTRUCTOR_FUNCTION(registerTuple)
 
 Stream::Stream() : Stream(nullptr) {
 }
@@ -75,26 +95,120 @@ Stream Stream::createOnCompleted(std::function<void (const QVariant& val)> last)
 }
 
 
-Stream Stream::createEach(std::function<void (const QVariant&)> f) {
+Stream Stream::createEach(Callable<void (const QVariant&)> f) {
     Q_ASSERT(f);
-    return Stream(new Each(f, stream()), *this);
+    return Stream(new Each(std::move(f), stream()), *this);
 }
 
 Stream Stream::iterate() {
     return Stream(new List(nullptr, stream()), *this);
 }
 
-Stream Stream::createBuffer(int max) {
-    return Stream(new Buffer(max, stream()), *this);
+Stream Stream::createBuffer(int max, qint64 spillBytes) {
+    return Stream(new Buffer(max, spillBytes, stream()), *this);
 }
 
 Stream Stream::createCompleteFilter(std::function<bool (const QVariant&)> f) {
     return Stream(new CompleteFilter(f, stream()), *this);
 }
 
-Stream Stream::createMap(std::function<QVariant(const QVariant&)> f) {
+Stream Stream::createTake(int count, std::function<bool (const QVariant&)> f) {
+    return Stream(new Take(count, f, stream()), *this);
+}
+
+Stream Stream::createSkip(int count, std::function<bool (const QVariant&)> f) {
+    return Stream(new Skip(count, f, stream()), *this);
+}
+
+Stream Stream::limit(int count) {
+    return createTake(count, nullptr);
+}
+
+Stream Stream::skip(int count) {
+    return createSkip(count, nullptr);
+}
+
+Stream Stream::first() {
+    return createTake(1, nullptr);
+}
+
+Stream Stream::last() {
+    auto* v = new QVariant();
+    own(v);
+    return createScan([v]() {
+        return *v;
+    }, [v](const QVariant & val) {
+        *v = val;
+    });
+}
+
+Stream Stream::writeTo(QIODevice* device, int bufferSize, int flushMs, qint64 maxPending) {
+    Q_ASSERT(device);
+    auto writer = new Writer(device, bufferSize, flushMs, maxPending, stream());
+    if(!device->parent()) {
+        device->setParent(writer);
+    }
+    if(!device->isOpen()) {
+        device->open(QIODevice::WriteOnly);
+    }
+    if(!device->isOpen()) {
+        auto producer = writer->producer();
+        producer->delayedCall([producer] {
+            producer->error(SimpleError("Cannot open", -1));
+        });
+    }
+    return Stream(writer, *this);
+}
+
+Stream Stream::toLocalSocket(const QString& name, int window) {
+    return Stream(new LocalSocketSink(name, window, stream()), *this);
+}
+
+Stream Stream::journal(const QString& path, int syncMs, qint64 segmentSize) {
+    auto journal = new Journal(path, syncMs, segmentSize, stream());
+    if(!journal->open()) {
+        auto producer = journal->producer();
+        producer->delayedCall([producer] {
+            producer->error(SimpleError("Cannot open", -1));
+        });
+    }
+    return Stream(journal, *this);
+}
+
+Stream Stream::measureLatency(const QString& name) {
+    return Stream(new LatencyProbe(name, stream()), *this);
+}
+
+Stream Stream::enableStats() {
+    for(auto s = stream(); s; s = s->parentStream()) {
+        Metrics::enable(s);
+    }
+    return *this;
+}
+
+QVariantList Stream::stats() const {
+    QVariantList list;
+    for(auto s = stream(); s; s = s->parentStream()) {
+        list.prepend(Metrics::stats(s));
+    }
+    return list;
+}
+
+QVariantMap Stream::graph() const {
+    auto root = stream();
+    while(root->parentStream()) {
+        root = root->parentStream();
+    }
+    return Graph::describe(root);
+}
+
+Stream Stream::lines() {
+    return Stream(new LineSplitter(stream()), *this);
+}
+
+Stream Stream::createMap(Callable<QVariant(const QVariant&)> f) {
     Q_ASSERT(f);
-    return Stream(new Map(f, stream()), *this);
+    return Stream(new Map(std::move(f), stream()), *this);
 }
 
 Stream Stream::createSpawn(std::function<Stream(const QVariant&)> f) {
@@ -134,16 +248,15 @@ void Stream::setChild(const Stream& stream) { //in theory lowerlevel supports mu
 }
 
 
-Stream Stream::createFilter(std::function<bool
-                            (const QVariant&)> f) {
+Stream Stream::createFilter(Callable<QVariant(const QVariant&)> f) {
     Q_ASSERT(f);
-    return Stream(new Filter(f, stream()), *this);
+    return Stream(new Filter(std::move(f), stream()), *this);
 }
 
-Stream Stream::createScan(std::function<QVariant()> getAcc,
-                          std::function<void (const QVariant&)> f) {
+Stream Stream::createScan(Callable<QVariant()> getAcc,
+                          Callable<void (const QVariant&)> f) {
     Q_ASSERT(f);
-    return Stream(new Scan(getAcc, f, stream()), *this);
+    return Stream(new Scan(std::move(getAcc), std::move(f), stream()), *this);
 }
 
 static int to(Axq::Stream::InfoValues i) {
@@ -171,6 +284,22 @@ Stream Stream::createDelay(int delayMs) {
     return Stream(new Delay(stream(), delayMs), *this);
 }
 
+Stream Stream::debounce(int ms) {
+    return Stream(new Throttle(Throttle::Debounce, ms, stream()), *this);
+}
+
+Stream Stream::throttleFirst(int ms) {
+    return Stream(new Throttle(Throttle::ThrottleFirst, ms, stream()), *this);
+}
+
+Stream Stream::throttleLatest(int ms) {
+    return Stream(new Throttle(Throttle::ThrottleLatest, ms, stream()), *this);
+}
+
+Stream Stream::sample(int ms) {
+    return Stream(new Throttle(Throttle::Sample, ms, stream()), *this);
+}
+
 Stream Stream::createList(std::function<QVariant(const QVariant&)> f) {
     Q_ASSERT(f);
     return Stream(new List(f, stream()), *this);
@@ -196,8 +325,12 @@ StreamBase* Stream::stream() const {
     return m_ptr;
 }
 
-Stream Stream::createIterator(Keeper* iterator, std::function<bool ()> hasNext, std::function<QVariant()> next) {
-    return  Stream(new Iterator<std::nullptr_t>(hasNext, next, [iterator]() {delete iterator;}, nullptr));
+Stream Stream::createIterator(Keeper* iterator, Callable<bool ()> hasNext, Callable<QVariant()> next) {
+    return  Stream(new Iterator<std::nullptr_t>(std::move(hasNext), std::move(next), [iterator]() {delete iterator;}, nullptr));
+}
+
+Stream Stream::createIndexed(qint64 count, Callable<QVariant(qint64)> at) {
+    return  Stream(new Indexed<std::nullptr_t>(count, std::move(at), nullptr));
 }
 
 Stream Stream::createContainer(const QVariant& container) {
@@ -268,9 +401,9 @@ void Stream::complete() {
     stream()->producer()->cancel();
 }
 
-Stream Stream::createRepeater(std::function<QVariant()> f, int intervalMs) {
+Stream Stream::createRepeater(Callable<QVariant()> f, int intervalMs) {
     Q_ASSERT(f);
-    Axq::ProducerBase* ptr = new Axq::Repeater(f, intervalMs, nullptr);
+    Axq::ProducerBase* ptr = new Axq::Repeater(std::move(f), intervalMs, nullptr);
     return Stream(ptr);
 }
 
@@ -320,17 +453,150 @@ Stream Axq::read(QIODevice* device, int len) {
     return Stream(ptr);
 }
 
-Stream Stream::create(std::function<QVariant()> function) {
+Stream Axq::readMapped(QFile* file, int len) {
+    auto mapped = new QFile(file->fileName()); //views may outlive the file, thus mapped via own handle
+    const auto size = mapped->open(QIODevice::ReadOnly) ? mapped->size() : 0;
+    auto data = size > 0 ? mapped->map(0, size) : nullptr;
+    if(!data) {
+        delete mapped;
+        return Axq::read(file, len); //not mappable (empty, not a regular file...), read does the rest
+    }
+    auto ptr = new Axq::MappedFile(mapped, data, size, len, nullptr);
+    if(!file->parent()) {
+        file->setParent(ptr);
+    }
+    return Stream(ptr);
+}
+
+Stream Axq::lines(QIODevice* device, int blockSize) {
+    auto ptr = new Axq::LineReader(device, blockSize, nullptr);
+    if(!device->parent()) {
+        device->setParent(ptr);
+    }
+    if(!device->isOpen()) {
+        device->open(QIODevice::ReadOnly);
+    }
+    if(!device->isOpen()) {
+        ptr->delayedCall([ptr] {
+            ptr->error(SimpleError("Cannot open", -1));
+        });
+    }
+    return Stream(ptr);
+}
+
+Stream Axq::asyncRead(const QString& path, int chunkSize, int depth) {
+    return Stream(new Axq::AsyncRead(new Axq::ReadAhead(nullptr, path, chunkSize, depth), nullptr));
+}
+
+Stream Axq::asyncRead(QIODevice* device, int chunkSize, int depth) {
+    if(device->parent() || device->thread() != QThread::currentThread()) {
+        return Axq::read(device, chunkSize); //cannot be moved to the reading thread
+    }
+    return Stream(new Axq::AsyncRead(new Axq::ReadAhead(device, QString(), chunkSize, depth), nullptr));
+}
+
+Stream Axq::fromLocalSocket(const QString& name, int window) {
+    auto ptr = new Axq::LocalSocketSource(name, window, nullptr);
+    if(!ptr->listen()) {
+        ptr->delayedCall([ptr] {
+            ptr->error(SimpleError("Cannot listen", -1));
+        });
+    }
+    return Stream(ptr);
+}
+
+Stream Axq::replay(const QString& path, qint64 fromOffset) {
+    return Stream(new Axq::Replay(path, fromOffset, nullptr));
+}
+
+QVariantList Axq::allStats() {
+    return Metrics::all();
+}
+
+QByteArray Axq::dumpGraph(GraphFormat format) {
+    const auto graphs = Graph::all();
+    return format == GraphFormat::Json ? Graph::json(graphs) : Graph::dot(graphs);
+}
+
+void Axq::setAccounting(bool enabled, int sampleInterval) {
+    Accounting::setEnabled(enabled, sampleInterval);
+}
+
+QVariantMap Axq::accountingReport() {
+    return Accounting::report();
+}
+
+QVariantMap Axq::latencyStats() {
+    return Latency::all();
+}
+
+QByteArray Axq::dumpLatency() {
+    return Latency::dump();
+}
+
+void Axq::startTrace() {
+    Trace::start();
+}
+
+void Axq::stopTrace() {
+    Trace::stop();
+}
+
+bool Axq::writeTrace(const QString& path) {
+    if(Trace::enabled()) {
+        return false;   //recording threads may still restart their buffers
+    }
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    const auto json = Trace::json();
+    return file.write(json) == json.size();
+}
+
+QVariantMap Axq::poolStats() {
+    QVariantMap stats;
+#ifdef AXQ_NO_NODE_POOL
+    stats.insert("enabled", false);
+#else
+    stats.insert("enabled", true);
+#endif
+    stats.insert("chunks", static_cast<qulonglong>(NodePool::chunks()));
+    stats.insert("bytes", static_cast<qulonglong>(NodePool::chunks() * NodePool::ChunkSize));
+    return stats;
+}
+
+Stream Stream::create(Callable<QVariant()> function) {
     Q_ASSERT(function);
-    ProducerBase* ptr = new Axq::FuncProducer(function, nullptr);
+    ProducerBase* ptr = new Axq::FuncProducer(std::move(function), nullptr);
     return Stream(ptr);
 }
 
 Stream Axq::range(int begin, int end, int step) {
-    Axq::ProducerBase* ptr = new Axq::Range<std::nullptr_t>(begin, end, step, nullptr);
+    Axq::ProducerBase* ptr = new Axq::Range<int, std::nullptr_t>(begin, end, step, nullptr);
     return Stream(ptr);
 }
 
+Stream Stream::createRange(qint64 begin, qint64 end, qint64 step, int blockSize) {
+    return Stream(new Axq::Range<qint64, std::nullptr_t>(begin, end, step, blockSize, nullptr));
+}
+
+Stream Stream::createRange(double begin, double end, double step, int blockSize) {
+    return Stream(new Axq::Range<double, std::nullptr_t>(begin, end, step, blockSize, nullptr));
+}
+
+Stream Axq::from(QVariantList&& list) {
+    return Stream(new Container<QVariantList, std::nullptr_t>(std::move(list), nullptr));
+}
+
+Stream Axq::from(QVariantMap&& map) {
+    return Stream(new Container<QVariantMap, std::nullptr_t>(std::move(map), nullptr));
+}
+
+Stream Axq::from(QVariantHash&& hash) {
+    return Stream(new Container<QVariantHash, std::nullptr_t>(std::move(hash), nullptr));
+}
+
 Stream Axq::from(QObject* object) {
     Axq::ProducerBase* ptr = new Axq::Value<std::nullptr_t>(QVariant::fromValue(object), nullptr);
     if(!object->parent()) {
@@ -349,6 +615,12 @@ Stream Axq::create(Queue* push) {
     if(!push->parent()) {
         push->setParent(ptr);
     }
+    const auto stamps = ptr->stamps();
+    //push time is taken in the pushing thread, before the value is queued to the producer. Every value
+    //gets a stamp, 0 when not measured, so that stamps stay paired if a probe appears or goes meanwhile
+    QObject::connect(push, static_cast<void (Queue::*)(const QVariant&) >(&Queue::push), push, [stamps]() {
+        stamps->push(Latency::active() ? Latency::now() : 0);
+    }, Qt::DirectConnection);
     QObject::connect(push, static_cast<void (Queue::*)(const QVariant&) >(&Queue::push), ptr, &QueueProducer::push);
     QObject::connect(push, &Queue::complete, ptr, &QueueProducer::doComplete);
     return Stream(ptr);
@@ -399,12 +671,34 @@ void Stream::applyParent(QObject* obj) {
     obj->setParent(owner);
 }
 
-Stream Stream::onBufferCompleted(std::function<void (const QByteArray &)> last) {
-    return createOnCompleted([last](const QVariant & v) {
-        QByteArray arr;
-        const auto p = convert<ParamList>(v);
-        std::for_each(p.begin(), p.end(), [&arr](const auto& v){arr += v.toByteArray();});
-        last(arr);
+Stream Stream::onBufferCompleted(std::function<void (const QByteArray &)> last, int reserve) {
+    Q_ASSERT(last);
+    auto* bytes = new QByteArray();
+    own(bytes);
+    if(reserve > 0) {
+        bytes->reserve(reserve);
+    }
+    const auto append = [bytes](const QVariant & v) {
+        if(bytes->isEmpty() && bytes->capacity() == 0 && v.userType() == QMetaType::QByteArray) {
+            *bytes = v.toByteArray(); //shared, a single chunk is never copied
+        } else {
+            bytes->append(v.toByteArray());
+        }
+    };
+    auto each = createEach([append](const QVariant & v) {
+        if(v.userType() == QMetaType::QVariantList) { //e.g. buffer()
+            for(const auto& item : v.value<ParamList>()) {
+                append(item);
+            }
+        } else {
+            append(v);
+        }
     });
+    stream()->root()->pushCompleteHandler([last, bytes](ProducerBase*) {
+        const auto out = std::move(*bytes); //Stream lets go, the handler may keep it
+        *bytes = QByteArray();
+        last(out);
+    });
+    return each;
 }
 
@@ -0,0 +1,190 @@
+#include "axq_graph.h"
+#include "axq_streams.h"
+#include <atomic>
+#include <memory>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+
+using namespace Axq;
+
+namespace {
+
+/*
+ * Roots of one thread. The set is used only in its own thread, so registering a root is cheap
+ * and a root is never read while being destroyed. Other threads reach it via its event loop.
+ */
+class Agent : public QObject {
+public:
+    QVariantList describeAll() const {
+        QVariantList graphs;
+        for(const auto root : roots) {
+            if(root->thread() == thread() && !root->parentStream()) { //moved one is added in its new thread
+                graphs.append(Graph::describe(root));
+            }
+        }
+        return graphs;
+    }
+    QSet<StreamBase*> roots;
+};
+
+QMutex registryMutex;
+QSet<Agent*> registry; //one per thread having roots
+
+thread_local Agent* localAgent = nullptr;
+thread_local bool agentDestroyed = false;   //roots may still be deleted at thread exit
+
+struct AgentHolder {
+    ~AgentHolder() {
+        agentDestroyed = true;
+        if(localAgent) {
+            {
+                QMutexLocker lock(&registryMutex);
+                registry.remove(localAgent);
+            }
+            delete localAgent;  //its pending describe call is dropped
+            localAgent = nullptr;
+        }
+    }
+};
+
+thread_local AgentHolder agentHolder;
+
+Agent* agent() {
+    if(!localAgent && !agentDestroyed) {
+        (void) &agentHolder; //odr-use, so it is constructed and destroyed at thread exit
+        localAgent = new Agent();
+        QMutexLocker lock(&registryMutex);
+        registry.insert(localAgent);
+    }
+    return localAgent;
+}
+
+QString streamId(const StreamBase* stream) {
+    return QString("0x%1").arg(reinterpret_cast<quintptr>(stream), 0, 16);
+}
+
+void walk(StreamBase* stream, QVariantList& nodes, QVariantList& edges) {
+    nodes.append(Metrics::stats(stream));
+    for(auto child : stream->QObject::children()) {
+        auto s = qobject_cast<StreamBase*>(child); //may have even non-streambase children
+        if(s) {
+            edges.append(QVariant(QVariantList{streamId(stream), streamId(s)}));
+            walk(s, nodes, edges);
+        }
+    }
+}
+
+QByteArray quoted(const QString& str) {
+    auto bytes = str.toUtf8();
+    return '"' + bytes.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n") + '"';
+}
+
+}
+
+void Graph::add(StreamBase* root) {
+    const auto a = agent();
+    if(a) {
+        a->roots.insert(root);
+    }
+}
+
+bool Graph::remove(StreamBase* root) {
+    //a root deleted from another thread is allowed only after its thread has exited, and its agent with it
+    return localAgent && localAgent->roots.remove(root);
+}
+
+QVariantMap Graph::describe(StreamBase* root) {
+    Q_ASSERT(root->thread() == QThread::currentThread());
+    QVariantList nodes;
+    QVariantList edges;
+    walk(root, nodes, edges);
+    QVariantMap graph;
+    graph.insert("root", streamId(root));
+    graph.insert("thread", Metrics::threadName(root->thread()));
+    graph.insert("nodes", nodes);
+    graph.insert("edges", edges);
+    return graph;
+}
+
+QVariantList Graph::all(int timeoutMs) {
+    struct Pending {
+        QString thread;
+        std::shared_ptr<QVariantList> graphs;
+        std::shared_ptr<std::atomic<bool>> ready;
+    };
+    QVariantList graphs;
+    QList<Pending> pending;
+    const auto done = std::make_shared<QSemaphore>();
+    {
+        //posting under the lock, an agent cannot be deleted meanwhile and its pending call is dropped if deleted later
+        QMutexLocker lock(&registryMutex);
+        for(const auto a : registry) {
+            if(a == localAgent) {
+                graphs.append(a->describeAll());
+                continue;
+            }
+            const Pending p{Metrics::threadName(a->thread()), std::make_shared<QVariantList>(),
+                            std::make_shared<std::atomic<bool>>(false)};
+            const auto result = p.graphs;
+            const auto ready = p.ready;
+            QMetaObject::invokeMethod(a, [a, result, ready, done]() {
+                *result = a->describeAll();
+                ready->store(true, std::memory_order_release);
+                done->release();
+            }, Qt::QueuedConnection);
+            pending.append(p);
+        }
+    }
+    //a thread busy or blocked beyond timeout is reported unresponsive
+    done->tryAcquire(pending.size(), timeoutMs);
+    for(const auto& p : pending) {
+        if(p.ready->load(std::memory_order_acquire)) {
+            graphs.append(*p.graphs);
+        } else {
+            graphs.append(QVariantMap{{"root", p.thread}, {"thread", p.thread}, {"unresponsive", true}});
+        }
+    }
+    return graphs;
+}
+
+QByteArray Graph::dot(const QVariantList& graphs) {
+    QByteArray out("digraph axq {\n    node [shape=box];\n");
+    int index = 0;
+    for(const auto& g : graphs) {
+        const auto graph = g.toMap();
+        out += "    subgraph cluster_" + QByteArray::number(index++) + " {\n        label=" +
+               quoted(graph.value("thread").toString()) + ";\n";
+        if(graph.value("unresponsive").toBool()) {
+            out += "        " + quoted(graph.value("root").toString()) + " [label=\"unresponsive\", style=dashed];\n";
+        }
+        for(const auto& n : graph.value("nodes").toList()) {
+            const auto node = n.toMap();
+            QString label = node.value("type").toString();
+            if(node.contains("out")) {
+                label += QString("\nin %1 out %2\n%3/s").arg(node.value("in").toULongLong())
+                         .arg(node.value("out").toULongLong()).arg(node.value("outPerSec").toDouble(), 0, 'f', 1);
+            }
+            if(node.value("queued").toLongLong() > 0) {
+                label += QString("\nqueued %1").arg(node.value("queued").toLongLong());
+            }
+            out += "        " + quoted(node.value("id").toString()) + " [label=" + quoted(label);
+            if(node.value("waiting").toBool()) {
+                out += ", color=red";
+            }
+            out += "];\n";
+        }
+        for(const auto& e : graph.value("edges").toList()) {
+            const auto edge = e.toList();
+            out += "        " + quoted(edge.value(0).toString()) + " -> " + quoted(edge.value(1).toString()) + ";\n";
+        }
+        out += "    }\n";
+    }
+    out += "}\n";
+    return out;
+}
+
+QByteArray Graph::json(const QVariantList& graphs) {
+    return QJsonDocument::fromVariant(graphs).toJson();
+}
@@ -0,0 +1,343 @@
+#include "axq_journal.h"
+#include "axq_codec.h"
+#include <algorithm>
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Axq;
+
+// Journal is a set of segments "<path>.<number of first record>.log", each starts with Codec header
+// followed by records: varint length and Codec encoded value. Along each segment there is an index
+// "<path>.<number of first record>.idx" that has (record number, position) for every IndexInterval record.
+namespace {
+
+constexpr int IndexInterval = 1024;
+constexpr int IndexEntry = 16;
+constexpr char SegmentSuffix[] = ".log";
+constexpr char IndexSuffix[] = ".idx";
+
+QString segmentName(const QString& path, qint64 first, const char* suffix) {
+    return QString("%1.%2%3").arg(path).arg(first, 20, 10, QChar('0')).arg(QLatin1String(suffix));
+}
+
+QList<QPair<qint64, QString>> segments(const QString& path) {
+    const QFileInfo info(path);
+    const auto dir = info.absoluteDir();
+    const auto base = info.fileName();
+    const int suffix = static_cast<int>(sizeof(SegmentSuffix)) - 1;
+    QList<QPair<qint64, QString>> list;
+    //zero padded, so sorted by name is sorted by number
+    for(const auto& name : dir.entryList({base + ".*" + SegmentSuffix}, QDir::Files, QDir::Name)) {
+        bool ok = false;
+        const auto first = name.mid(base.size() + 1, name.size() - base.size() - 1 - suffix).toLongLong(&ok);
+        if(ok) {
+            list.append({first, dir.filePath(name)});
+        }
+    }
+    return list;
+}
+
+bool skipRecord(const char*& pos, const char* end) {
+    auto p = pos;
+    quint64 len;
+    if(!Codec::getVarint(p, end, len) || len > static_cast<quint64>(end - p)) {
+        return false;
+    }
+    pos = p + len;
+    return true;
+}
+
+// false if the record is torn or invalid
+bool readRecord(const char*& pos, const char* end, QVariant& value) {
+    auto p = pos;
+    if(!skipRecord(p, end)) {
+        return false;
+    }
+    auto v = pos;
+    quint64 len;
+    Codec::getVarint(v, end, len);
+    if(!Codec::decode(v, p, value) || v != p) {
+        return false;
+    }
+    pos = p;
+    return true;
+}
+
+void syncFile(QFile* file) {
+    file->flush();
+#if defined(Q_OS_WIN)
+    ::_commit(file->handle());
+#else
+    ::fsync(file->handle());
+#endif
+}
+
+}
+
+Journal::Journal(const QString& path, int syncMs, qint64 segmentSize, StreamBase* parent) : Operator(parent),
+    m_path(path), m_segmentSize(segmentSize), m_timer(new QTimer(this)) {
+    m_payload.reserve(0x100); //reserved keeps its capacity over resize(0)
+    m_length.reserve(10);
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(std::max(0, syncMs));
+    QObject::connect(m_timer, &QTimer::timeout, this, &Journal::sync);
+    QObject::connect(m_parent, &StreamBase::next,  this, [this](const QVariant & value) {
+        write(value);
+        emit next(value);
+    });
+    QObject::connect(m_parent, &StreamBase::finished, this, [this](ProducerBase * origin) {
+        Q_UNUSED(origin);
+        sync();
+    });
+}
+
+Journal::~Journal() {
+    sync();
+}
+
+bool Journal::open() {
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    const auto existing = segments(m_path);
+    if(existing.isEmpty()) {
+        return openSegment(0, 0);
+    }
+    return recover(existing.last().first, existing.last().second);
+}
+
+// find the last complete record, a crash may have left a torn one
+bool Journal::recover(qint64 first, const QString& name) {
+    QFile file(name);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const auto size = file.size();
+    auto data = size > 0 ? file.map(0, size) : nullptr;
+    qint64 valid = 0;
+    qint64 count = 0;
+    if(data) {
+        const auto begin = reinterpret_cast<const char*>(data);
+        const auto end = begin + size;
+        auto pos = begin;
+        if(Codec::checkHeader(pos, end)) {
+            valid = pos - begin;
+            QVariant value;
+            while(readRecord(pos, end, value)) {
+                ++count;
+                valid = pos - begin;
+            }
+        }
+    }
+    file.close();
+    if(!openSegment(first, valid)) {
+        return false;
+    }
+    m_next = first + count;
+    return true;
+}
+
+bool Journal::openSegment(qint64 first, qint64 size) {
+    closeSegment();
+    m_file = new QFile(segmentName(m_path, first, SegmentSuffix), this);
+    m_index = new QFile(segmentName(m_path, first, IndexSuffix), this);
+    if(!m_file->open(QIODevice::ReadWrite) || !m_index->open(QIODevice::ReadWrite)) {
+        closeSegment();
+        return false;
+    }
+    m_first = first;
+    m_next = first;
+    if(m_file->size() != size) {
+        m_file->resize(size);   //drop torn tail
+    }
+    m_file->seek(size);
+    if(size == 0) {
+        QByteArray header;
+        Codec::header(header);
+        m_file->write(header);
+    }
+    //drop index entries for dropped records
+    auto entries = m_index->size() / IndexEntry;
+    while(entries > 0) {
+        m_index->seek((entries - 1) * IndexEntry + 8);
+        const auto entry = m_index->read(8);
+        if(entry.size() == 8 && qFromLittleEndian<qint64>(entry.constData()) < size) {
+            break;
+        }
+        --entries;
+    }
+    m_index->resize(entries * IndexEntry);
+    m_index->seek(entries * IndexEntry);
+    return true;
+}
+
+void Journal::closeSegment() {
+    sync();
+    delete m_file;
+    delete m_index;
+    m_file = nullptr;
+    m_index = nullptr;
+}
+
+void Journal::write(const QVariant& value) {
+    if(!m_file) {
+        return;
+    }
+    m_payload.resize(0);
+    if(!Codec::encode(value, m_payload)) {
+        emit producer()->error(SimpleError(QString("Cannot journal %1").arg(value.typeName()), -1));
+        return;
+    }
+    if((m_next - m_first) % IndexInterval == 0) {
+        char entry[IndexEntry];
+        qToLittleEndian<qint64>(m_next, entry);
+        qToLittleEndian<qint64>(m_file->pos(), entry + 8);
+        m_index->write(entry, IndexEntry);
+    }
+    m_length.resize(0);
+    Codec::putVarint(m_length, static_cast<quint64>(m_payload.size()));
+    if(m_file->write(m_length) < 0 || m_file->write(m_payload) < 0) {
+        emit producer()->error(SimpleError(m_file->errorString(), -1));
+        return;
+    }
+    ++m_next;
+    m_dirty = true;
+    if(m_file->pos() >= m_segmentSize) {
+        const auto next = m_next;
+        if(!openSegment(next, 0)) {
+            emit producer()->error(SimpleError(QString("Cannot open %1").arg(m_path), -1));
+        }
+        return;
+    }
+    if(m_timer->interval() == 0) {
+        sync();
+    } else if(!m_timer->isActive()) {
+        m_timer->start();
+    }
+}
+
+void Journal::sync() {
+    m_timer->stop();
+    if(!m_file || !m_dirty) {
+        return;
+    }
+    m_dirty = false;
+    syncFile(m_index);
+    syncFile(m_file);
+}
+
+void Journal::cancel() {
+    m_timer->stop();
+    sync();
+}
+
+
+Replay::Replay(const QString& path, qint64 from, std::nullptr_t) : Serializer(nullptr),
+    m_from(std::max<qint64>(0, from)) {
+    const auto all = segments(path);
+    int start = 0;
+    for(int i = 0; i < all.size(); i++) {
+        if(all.at(i).first <= m_from) {
+            start = i;
+        }
+    }
+    m_segments = all.mid(start);
+    delayedCall([this]() {
+        if(!hasData()) {
+            complete();
+        }
+    });
+}
+
+bool Replay::hasData() const {
+    return m_pos < m_end || !m_segments.isEmpty();
+}
+
+void Replay::cancel() {
+    m_segments.clear();
+    closeSegment();
+    ProducerBase::cancel();
+}
+
+void Replay::onNext() {
+    forever {
+        if(m_pos >= m_end && !openNext()) {
+            return;
+        }
+        if(m_record < m_from) {
+            if(!skipRecord(m_pos, m_end)) {
+                closeSegment();
+            } else {
+                ++m_record;
+            }
+            continue;
+        }
+        QVariant value;
+        if(!readRecord(m_pos, m_end, value)) {
+            closeSegment(); //torn tail, the rest is in next segment if any
+            continue;
+        }
+        ++m_record;
+        emit next(value);
+        return;
+    }
+}
+
+bool Replay::openNext() {
+    closeSegment();
+    while(!m_segments.isEmpty()) {
+        const auto segment = m_segments.takeFirst();
+        m_file = new QFile(segment.second, this);
+        const auto size = m_file->open(QIODevice::ReadOnly) ? m_file->size() : 0;
+        const auto data = size > 0 ? m_file->map(0, size) : nullptr;
+        if(!data) {
+            emit error(SimpleError(QString("Cannot open %1").arg(segment.second), -1));
+            closeSegment();
+            continue;
+        }
+        const auto begin = reinterpret_cast<const char*>(data);
+        m_pos = begin;
+        m_end = begin + size;
+        if(!Codec::checkHeader(m_pos, m_end)) {
+            emit error(SimpleError(QString("Invalid journal %1").arg(segment.second), -1));
+            closeSegment();
+            continue;
+        }
+        m_record = segment.first;
+        if(m_record < m_from) {
+            seekIndex(segment.second, begin);
+        }
+        return true;
+    }
+    return false;
+}
+
+// jump to closest indexed record before the requested one
+void Replay::seekIndex(const QString& name, const char* begin) {
+    QFile index(name.left(name.size() - static_cast<int>(sizeof(SegmentSuffix)) + 1) + IndexSuffix);
+    if(!index.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const auto entries = index.readAll();
+    for(int i = 0; i + IndexEntry <= entries.size(); i += IndexEntry) {
+        const auto record = qFromLittleEndian<qint64>(entries.constData() + i);
+        const auto pos = qFromLittleEndian<qint64>(entries.constData() + i + 8);
+        if(record > m_from || pos >= m_end - begin) {
+            break;
+        }
+        m_record = record;
+        m_pos = begin + pos;
+    }
+}
+
+void Replay::closeSegment() {
+    delete m_file; //unmaps
+    m_file = nullptr;
+    m_pos = nullptr;
+    m_end = nullptr;
+}
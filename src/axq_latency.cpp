@@ -0,0 +1,136 @@
+#include "axq_latency.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <QMap>
+#include <QtAlgorithms>
+
+using namespace Axq;
+
+namespace {
+
+QMutex registryMutex;
+QMap<QString, std::shared_ptr<LatencyHistograms>> registry;   //by name, kept as probes of same name may come later
+thread_local LatencyContext localContext;
+
+const double Percentiles[] = {50.0, 75.0, 90.0, 99.0, 99.9, 99.99, 100.0};
+
+double toUs(qint64 ns) {
+    return static_cast<double>(ns) / 1000.0;
+}
+
+}
+
+std::atomic<int> Latency::s_probes{0};
+
+Histogram::Histogram() : m_counts(new std::atomic<quint64>[Counts]) {
+    for(int i = 0; i < Counts; i++) {
+        m_counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+int Histogram::index(qint64 value) {
+    const auto v = static_cast<quint64>(std::min(std::max<qint64>(0, value), (Q_INT64_C(1) << MaxBits) - 1));
+    const int msb = 63 - static_cast<int>(qCountLeadingZeroBits(v | (SubBuckets - 1)));
+    const int bucket = msb - (SubBits - 1);
+    const int sub = static_cast<int>(v >> bucket);
+    return (bucket + 1) * SubHalf + (sub - SubHalf);
+}
+
+qint64 Histogram::highest(int index) {
+    int bucket = index / SubHalf - 1;
+    qint64 sub = index % SubHalf + SubHalf;
+    if(bucket < 0) {
+        bucket = 0;
+        sub -= SubHalf;
+    }
+    return ((sub + 1) << bucket) - 1;
+}
+
+void Histogram::record(qint64 ns) {
+    m_counts[index(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(ns, std::memory_order_relaxed);
+    auto min = m_min.load(std::memory_order_relaxed);
+    while(ns < min && !m_min.compare_exchange_weak(min, ns, std::memory_order_relaxed)) {}
+    auto max = m_max.load(std::memory_order_relaxed);
+    while(ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+}
+
+quint64 Histogram::count() const {
+    return m_total.load(std::memory_order_relaxed);
+}
+
+qint64 Histogram::percentile(double percent) const {
+    const auto total = count();
+    if(total == 0) {
+        return 0;
+    }
+    const auto target = std::max<quint64>(1, static_cast<quint64>(std::ceil(percent / 100.0 * total)));
+    const auto max = m_max.load(std::memory_order_relaxed);
+    quint64 cumulative = 0;
+    for(int i = 0; i < Counts; i++) {
+        cumulative += m_counts[i].load(std::memory_order_relaxed);
+        if(cumulative >= target) {
+            return std::min(highest(i), max);
+        }
+    }
+    return max;
+}
+
+QVariantMap Histogram::stats() const {
+    QVariantMap map;
+    const auto total = count();
+    map.insert("count", total);
+    if(total > 0) {
+        map.insert("minUs", toUs(m_min.load(std::memory_order_relaxed)));
+        map.insert("meanUs", toUs(m_sum.load(std::memory_order_relaxed)) / total);
+        map.insert("maxUs", toUs(m_max.load(std::memory_order_relaxed)));
+    }
+    map.insert("p50Us", toUs(percentile(50.0)));
+    map.insert("p99Us", toUs(percentile(99.0)));
+    map.insert("p999Us", toUs(percentile(99.9)));
+    return map;
+}
+
+qint64 Latency::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LatencyContext& Latency::context() {
+    return localContext;
+}
+
+std::shared_ptr<LatencyHistograms> Latency::histograms(const QString& name) {
+    QMutexLocker lock(&registryMutex);
+    auto& h = registry[name];
+    if(!h) {
+        h = std::make_shared<LatencyHistograms>();
+    }
+    return h;
+}
+
+QVariantMap Latency::all() {
+    QVariantMap map;
+    QMutexLocker lock(&registryMutex);
+    for(auto it = registry.begin(); it != registry.end(); ++it) {
+        map.insert(it.key(), QVariantMap{{"endToEnd", it.value()->endToEnd.stats()}, {"stage", it.value()->stage.stats()}});
+    }
+    return map;
+}
+
+QByteArray Latency::dump() {
+    QByteArray out;
+    QMutexLocker lock(&registryMutex);
+    for(auto it = registry.begin(); it != registry.end(); ++it) {
+        const QPair<const char*, const Histogram*> histograms[] = {{"end-to-end", &it.value()->endToEnd}, {"stage", &it.value()->stage}};
+        for(const auto& h : histograms) {
+            out += it.key().toUtf8() + ' ' + h.first + " count " + QByteArray::number(h.second->count()) + '\n';
+            for(const auto p : Percentiles) {
+                out += "    " + QByteArray::number(p, 'f', 2).rightJustified(7) + "% " +
+                       QByteArray::number(toUs(h.second->percentile(p)), 'f', 3).rightJustified(14) + " us\n";
+            }
+        }
+    }
+    return out;
+}
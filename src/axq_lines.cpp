@@ -0,0 +1,163 @@
+#include "axq_lines.h"
+#include <cstring>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define AXQ_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AXQ_SSE2
+#endif
+
+using namespace Axq;
+
+QByteArrayList Lines::toList() const {
+    QByteArrayList list;
+    list.reserve(count());
+    for(int i = 0; i < count(); i++) {
+        list.append(at(i));
+    }
+    return list;
+}
+
+void Axq::scanLines(const char* data, int size, int offset, QVector<int>& ends) {
+    int i = 0;
+#ifdef AXQ_AVX2
+    const __m256i nl32 = _mm256_set1_epi8('\n');
+    for(; i + 32 <= size; i += 32) {
+        const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, nl32)));
+        while(mask) {
+            ends.append(offset + i + static_cast<int>(qCountTrailingZeroBits(mask)));
+            mask &= mask - 1;
+        }
+    }
+#endif
+#ifdef AXQ_SSE2
+    const __m128i nl16 = _mm_set1_epi8('\n');
+    for(; i + 16 <= size; i += 16) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl16)));
+        while(mask) {
+            ends.append(offset + i + static_cast<int>(qCountTrailingZeroBits(mask)));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while(i < size) {
+        const auto nl = static_cast<const char*>(std::memchr(data + i, '\n', static_cast<size_t>(size - i)));
+        if(!nl) {
+            break;
+        }
+        const auto pos = static_cast<int>(nl - data);
+        ends.append(offset + pos);
+        i = pos + 1;
+    }
+}
+
+LineReader::LineReader(QIODevice* device, int blockSize, std::nullptr_t) : Serializer(nullptr),
+    m_device(device), m_blockSize(std::max(1, blockSize)) {
+    QObject::connect(m_device, &QObject::destroyed, this, [this]() {
+        m_device = nullptr;
+        m_carry.clear();
+    });
+    delayedCall([this]() {
+        if(!hasData()) {
+            complete();
+        }
+    });
+}
+
+bool LineReader::hasData() const {
+    return m_device && (!m_device->atEnd() || !m_carry.isEmpty());
+}
+
+void LineReader::cancel() {
+    m_device = nullptr;
+    m_carry.clear();
+    ProducerBase::cancel();
+}
+
+void LineReader::onNext() {
+    if(!hasData()) {
+        return;
+    }
+    // A new block each time, as lines of the previous block may still be referenced
+    const int carry = m_carry.size();
+    QByteArray block(carry + m_blockSize, Qt::Uninitialized);
+    if(carry > 0) {
+        std::memcpy(block.data(), m_carry.constData(), static_cast<size_t>(carry));
+    }
+    const auto read = m_device->atEnd() ? 0 : m_device->read(block.data() + carry, m_blockSize);
+    if(read < 0) {
+        m_carry.clear();
+        const auto message = m_device->errorString();
+        m_device = nullptr;
+        emit error(SimpleError(message, -1));
+        return;
+    }
+    const int size = carry + static_cast<int>(read);
+    block.resize(size);
+
+    QVector<int> ends;
+    ends.reserve(size / 32 + 1);
+    scanLines(block.constData() + carry, size - carry, carry, ends); //carry has no newlines
+    const int used = ends.isEmpty() ? 0 : ends.last() + 1;
+    if(m_device->atEnd()) {
+        if(used < size) {
+            ends.append(size); //last line without newline
+        }
+        m_carry.clear();
+    } else {
+        m_carry = block.mid(used);
+    }
+    if(!ends.isEmpty()) {
+        emit next(QVariant::fromValue(Lines(block, ends)));
+    }
+}
+
+LineSplitter::LineSplitter(StreamBase* parent) : Operator(parent) {
+    QObject::connect(m_parent, &StreamBase::next,  this, [this](const QVariant & value) {
+        const auto chunk = value.toByteArray();
+        const int carry = m_carry.size();
+        // Without carry the lines are views to the input chunk as is
+        const auto block = carry > 0 ? m_carry + chunk : chunk;
+        QVector<int> ends;
+        ends.reserve(chunk.size() / 32 + 1);
+        scanLines(block.constData() + carry, block.size() - carry, carry, ends);
+        if(ends.isEmpty()) {
+            m_carry = block;
+            return;
+        }
+        const int used = ends.last() + 1;
+        m_carry = used < block.size() ? block.mid(used) : QByteArray();
+        emit next(QVariant::fromValue(Lines(block, ends)));
+    });
+    //input may end without a newline, the carry is the last line
+    QObject::connect(m_parent, &StreamBase::finished, this, [this](ProducerBase * origin) {
+        Q_UNUSED(origin);
+        flush();
+    });
+}
+
+void LineSplitter::flush() {
+    if(!m_carry.isEmpty()) {
+        QVector<int> ends;
+        ends.append(m_carry.size());
+        const auto block = m_carry;
+        m_carry.clear();
+        emit next(QVariant::fromValue(Lines(block, ends)));
+    }
+    emit waitOver();
+}
+
+bool LineSplitter::wait() const {
+    return !m_carry.isEmpty();
+}
+
+void LineSplitter::cancel() {
+    m_carry.clear();
+    emit waitOver();
+}
@@ -0,0 +1,303 @@
+#include "axq_localsocket.h"
+#include "axq_codec.h"
+#include <algorithm>
+#include <QLocalSocket>
+#include <QLocalServer>
+#include <QtEndian>
+
+using namespace Axq;
+
+// Frame is a quint32 big endian payload length, a quint8 type and then the Codec encoded payload
+namespace {
+
+enum Frame : quint8 {ValueFrame = 1, CompleteFrame, ErrorFrame, AckFrame, HelloFrame};
+
+constexpr int HeaderSize = 5;
+constexpr int RetryMs = 100;
+
+void beginFrame(QByteArray& frame, Frame type) {
+    frame.resize(HeaderSize);
+    frame[4] = static_cast<char>(type);
+}
+
+void endFrame(QByteArray& frame) {
+    qToBigEndian<quint32>(static_cast<quint32>(frame.size() - HeaderSize), frame.data());
+}
+
+bool appendValue(QByteArray& frame, const QVariant& value) {
+    return Codec::encode(value, frame);
+}
+
+void appendError(QByteArray& frame, const Error& error) {
+    if(!Codec::encode(error.error(), frame)) {
+        Codec::encode(error.error().toString(), frame);
+    }
+    Codec::putVarint(frame, static_cast<quint64>(static_cast<qint64>(error.errorCode())));
+    frame.append(error.isFatal() ? '\1' : '\0');
+}
+
+bool readValue(const char* payload, int size, QVariant& value) {
+    const auto end = payload + size;
+    return Codec::decode(payload, end, value) && payload == end;
+}
+
+SimpleError readError(const char* payload, int size) {
+    const auto end = payload + size;
+    QVariant error;
+    quint64 code = 0;
+    Codec::decode(payload, end, error);
+    Codec::getVarint(payload, end, code);
+    const bool fatal = payload < end && *payload;
+    return SimpleError(error, static_cast<int>(static_cast<qint64>(code)), fatal);
+}
+
+bool nextFrame(const QByteArray& input, int& pos, Frame& type, const char*& payload, int& size) {
+    if(input.size() - pos < HeaderSize) {
+        return false;
+    }
+    const auto len = qFromBigEndian<quint32>(input.constData() + pos);
+    if(static_cast<quint32>(input.size() - pos - HeaderSize) < len) {
+        return false;
+    }
+    type = static_cast<Frame>(input.at(pos + 4));
+    payload = input.constData() + pos + HeaderSize;
+    size = static_cast<int>(len);
+    pos += HeaderSize + size;
+    return true;
+}
+
+}
+
+LocalSocketSink::LocalSocketSink(const QString& name, int window, StreamBase* parent) : Operator(parent),
+    m_socket(new QLocalSocket(this)), m_retry(new QTimer(this)), m_name(name), m_window(std::max(1, window)) {
+    m_retry->setSingleShot(true);
+    m_retry->setInterval(RetryMs);
+    QObject::connect(m_retry, &QTimer::timeout, this, &LocalSocketSink::connectServer);
+    QObject::connect(m_socket, &QLocalSocket::connected, this, [this]() {
+        if(!m_unsent.isEmpty()) {
+            m_socket->write(m_unsent);
+            m_unsent.clear();
+        }
+    });
+    QObject::connect(m_socket, &QLocalSocket::readyRead, this, &LocalSocketSink::onRead);
+    QObject::connect(m_socket, &QLocalSocket::disconnected, this, [this]() {
+        if(m_completing) {
+            done();
+        }
+    });
+    QObject::connect(m_socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError err) {
+        if(m_completing) {
+            done();
+        } else if(err == QLocalSocket::ServerNotFoundError || err == QLocalSocket::ConnectionRefusedError) {
+            m_retry->start(); //receiving end is not up yet
+        } else {
+            emit producer()->error(SimpleError(m_socket->errorString(), -1));
+        }
+    });
+    QObject::connect(m_parent, &StreamBase::next,  this, [this](const QVariant & value) {
+        beginFrame(m_frame, ValueFrame);
+        if(!appendValue(m_frame, value)) {
+            emit producer()->error(SimpleError(QString("Cannot encode %1").arg(value.typeName()), -1));
+            emit next(value);
+            return;
+        }
+        endFrame(m_frame);
+        send();
+        if(++m_inFlight >= m_window && !m_deferred) {
+            m_deferred = true;  //receiver has not acked, wait
+            producer()->defer();
+        }
+        emit next(value);
+    });
+    QObject::connect(producer(), &StreamBase::error, this, [this](const Error & err) {
+        beginFrame(m_frame, ErrorFrame);
+        appendError(m_frame, err);
+        endFrame(m_frame);
+        send();
+    });
+    //complete frame is acked by the receiver, see done()
+    QObject::connect(m_parent, &StreamBase::finished, this, [this](ProducerBase * origin) {
+        Q_UNUSED(origin);
+        if(m_ended) {
+            return; //complete re-emits finished, also after done()
+        }
+        m_ended = true;
+        m_completing = true;
+        beginFrame(m_frame, CompleteFrame);
+        endFrame(m_frame);
+        send();
+    });
+    beginFrame(m_frame, HelloFrame);
+    Codec::header(m_frame);
+    endFrame(m_frame);
+    send();
+    connectServer();
+}
+
+void LocalSocketSink::connectServer() {
+    m_socket->connectToServer(m_name);
+}
+
+void LocalSocketSink::send() {
+    if(m_socket->state() == QLocalSocket::ConnectedState) {
+        m_socket->write(m_frame);
+    } else {
+        m_unsent.append(m_frame);
+    }
+}
+
+void LocalSocketSink::onRead() {
+    m_input.append(m_socket->readAll());
+    int pos = 0;
+    Frame type;
+    const char* payload;
+    int size;
+    while(nextFrame(m_input, pos, type, payload, size)) {
+        if(type == AckFrame) {
+            m_inFlight -= static_cast<int>(qFromBigEndian<quint32>(payload));
+            if(m_deferred && m_inFlight < m_window) {
+                m_deferred = false;
+                producer()->requestAgain();
+            }
+        } else if(type == CompleteFrame) {
+            done();
+        }
+    }
+    m_input.remove(0, pos);
+}
+
+void LocalSocketSink::done() {
+    if(!m_completing) {
+        return;
+    }
+    m_completing = false;
+    m_socket->disconnectFromServer();
+    emit waitOver();
+}
+
+bool LocalSocketSink::wait() const {
+    return m_completing;
+}
+
+void LocalSocketSink::cancel() {
+    m_retry->stop();
+    m_socket->abort();
+    m_unsent.clear();
+    m_completing = false;
+    m_ended = true;
+    emit waitOver();
+}
+
+
+LocalSocketSource::LocalSocketSource(const QString& name, int window, std::nullptr_t) : QueueProducer(nullptr),
+    m_server(new QLocalServer(this)), m_name(name), m_window(std::max(1, window)) {
+    QObject::connect(m_server, &QLocalServer::newConnection, this, &LocalSocketSource::onConnection);
+}
+
+bool LocalSocketSource::listen() {
+    QLocalServer::removeServer(m_name); //stale one from crashed process
+    return m_server->listen(m_name);
+}
+
+void LocalSocketSource::onConnection() {
+    while(m_server->hasPendingConnections()) {
+        auto socket = m_server->nextPendingConnection();
+        if(m_socket) {
+            socket->abort(); //one sender per Stream
+            socket->deleteLater();
+            continue;
+        }
+        m_socket = socket;
+        QObject::connect(m_socket, &QLocalSocket::readyRead, this, &LocalSocketSource::onRead);
+        QObject::connect(m_socket, &QLocalSocket::disconnected, this, [this]() {
+            if(!m_done) {
+                m_done = true;
+                emit error(SimpleError("Disconnected", -1));
+                emit doComplete();
+            }
+        });
+    }
+}
+
+void LocalSocketSource::onRead() {
+    if(!m_socket) {
+        return;
+    }
+    m_input.append(m_socket->readAll());
+    int pos = 0;
+    Frame type;
+    const char* payload;
+    int size;
+    while(!m_deferred && !m_done && nextFrame(m_input, pos, type, payload, size)) {
+        switch(type) {
+        case ValueFrame: {
+            QVariant value;
+            if(readValue(payload, size, value)) {
+                emit push(value);
+            } else {
+                emit error(SimpleError("Cannot decode value", -1)); //e.g. type not registered in this end
+            }
+            if(++m_unacked >= std::max(1, m_window / 2)) {
+                ack();
+            }
+            break;
+        }
+        case ErrorFrame:
+            emit error(readError(payload, size));
+            break;
+        case HelloFrame:
+            if(!Codec::checkHeader(payload, payload + size)) {
+                m_done = true;
+                emit error(SimpleError("Incompatible sender", -1));
+                emit doComplete();
+            }
+            break;
+        case CompleteFrame:
+            m_done = true;
+            ack();
+            beginFrame(m_frame, CompleteFrame);
+            endFrame(m_frame);
+            m_socket->write(m_frame);
+            m_socket->flush();
+            emit doComplete();
+            break;
+        default:
+            break;
+        }
+    }
+    m_input.remove(0, pos);
+    ack();
+}
+
+void LocalSocketSource::ack() {
+    if(m_unacked == 0 || !m_socket) {
+        return;
+    }
+    beginFrame(m_frame, AckFrame);
+    m_frame.resize(HeaderSize + 4);
+    qToBigEndian<quint32>(static_cast<quint32>(m_unacked), m_frame.data() + HeaderSize);
+    endFrame(m_frame);
+    m_socket->write(m_frame);
+    m_unacked = 0;
+}
+
+void LocalSocketSource::request(int milliseconds) {
+    QueueProducer::request(milliseconds);
+    if(m_deferred) {
+        m_deferred = false;
+        onRead(); //pending frames
+    }
+}
+
+void LocalSocketSource::defer() {
+    m_deferred = true; //no more acks, sender stops when its window is full
+}
+
+void LocalSocketSource::cancel() {
+    m_done = true;
+    m_server->close();
+    if(m_socket) {
+        m_socket->abort();
+    }
+    QueueProducer::cancel();
+}
@@ -0,0 +1,109 @@
+#include "axq_metrics.h"
+#include "axq_streams.h"
+#include <QCoreApplication>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+
+using namespace Axq;
+
+namespace {
+
+QMutex registryMutex;
+QSet<const Metrics*> registry; //of streams having metrics
+
+QString streamType(const StreamBase* stream) {
+    return QString::fromLatin1(stream->metaObject()->className()).section("::", -1);
+}
+
+QString streamId(const StreamBase* stream) {
+    return QString("0x%1").arg(reinterpret_cast<quintptr>(stream), 0, 16);
+}
+
+}
+
+QString Metrics::threadName(const QThread* thread) {
+    if(!thread) {
+        return QString();
+    }
+    if(!thread->objectName().isEmpty()) {
+        return thread->objectName();
+    }
+    if(QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        return QStringLiteral("main");
+    }
+    return QString("0x%1").arg(reinterpret_cast<quintptr>(thread), 0, 16);
+}
+
+void Metrics::enable(StreamBase* stream) {
+    if(stream->m_metrics) {
+        return;
+    }
+    auto metrics = new Metrics();
+    metrics->since.start();
+    metrics->type = streamType(stream);
+    metrics->id = streamId(stream);
+    metrics->thread = threadName(stream->thread());
+    stream->m_metrics.reset(metrics);
+    QObject::connect(stream, &StreamBase::next, stream, [metrics]() {
+        Metrics::add(metrics->out);
+    });
+    QObject::connect(stream, &StreamBase::error, stream, [metrics]() {
+        Metrics::add(metrics->errors);
+    });
+    if(stream->m_parent) {
+        QObject::connect(stream->m_parent, &StreamBase::next, stream, [metrics]() {
+            Metrics::add(metrics->in);
+        });
+    }
+    QMutexLocker lock(&registryMutex);
+    registry.insert(metrics);
+}
+
+void Metrics::release(StreamBase* stream) {
+    if(!stream->m_metrics) {
+        return;
+    }
+    QMutexLocker lock(&registryMutex);
+    registry.remove(stream->m_metrics.get());
+}
+
+QVariantMap Metrics::stats(const StreamBase* stream) {
+    QVariantMap map;
+    map.insert("type", streamType(stream));
+    map.insert("id", streamId(stream));
+    if(stream->thread() == QThread::currentThread()) { //state cannot be read safely from other threads
+        map.insert("waiting", stream->wait());
+        map.insert("queued", stream->queued());
+    }
+    stream->appendStats(map);
+    if(stream->m_metrics) {
+        stream->m_metrics->append(map);
+    }
+    return map;
+}
+
+void Metrics::append(QVariantMap& map) const {
+    map.insert("in", get(in));
+    map.insert("out", get(out));
+    map.insert("errors", get(errors));
+    map.insert("callbacks", get(callbacks));
+    map.insert("callbackUs", get(callbackNs) / 1000);
+    const auto ms = since.elapsed();
+    map.insert("outPerSec", ms > 0 ? static_cast<double>(get(out)) * 1000.0 / ms : 0.0);
+}
+
+QVariantList Metrics::all() {
+    QVariantList list;
+    //streams may be in destruction in their threads, only names set at enable and counters are read
+    QMutexLocker lock(&registryMutex);
+    for(const auto metrics : registry) {
+        QVariantMap map;
+        map.insert("type", metrics->type);
+        map.insert("id", metrics->id);
+        map.insert("thread", metrics->thread);
+        metrics->append(map);
+        list.append(map);
+    }
+    return list;
+}
@@ -1,5 +1,6 @@
 #include "axq_operators.h"
 #include <QThread>
+#include <algorithm>
 
 using namespace Axq;
 
@@ -7,29 +8,106 @@ void Operator::initConnections() {
     connectFinished();
 }
 
-Buffer::Buffer(int max, StreamBase* parent) :
-    Operator(parent) {
+Buffer::Buffer(int max, qint64 spillBytes, StreamBase* parent) :
+    Operator(parent), m_spillBytes(spillBytes), m_buffer(spillBytes) {
     QObject::connect(m_parent, &StreamBase::next,  this, [this, max](const QVariant & value) {
-        if(m_buffer.length() < max) {
+        if(m_buffer.size() < max) {
             m_buffer.append(value);
+            const auto err = m_buffer.takeError();
+            if(!err.isEmpty()) {
+                emit producer()->error(SimpleError(err, -1)); //values are still buffered, in memory
+            }
         } else {
-            emit next(m_buffer);
-            m_buffer.clear();
+            flush();
         }
     });
 
     QObject::connect(m_parent->producer(), &ProducerBase::completed, this, [this](ProducerBase * origin) {
         if(origin == producer() && !m_buffer.isEmpty()) { //my producer
-            emit next(m_buffer);
-            m_buffer.clear();
+            flush();
         }
     });
 }
 
+void Buffer::flush() {
+    const auto buffer = m_buffer;
+    m_buffer = SpillList(m_spillBytes);
+    //only a spilled buffer is passed as is, a List and others can read it without loading it all
+    emit next(buffer.isSpilled() ? QVariant::fromValue(buffer) : QVariant(buffer.toList()));
+}
+
 void Buffer::cancel() {
     m_buffer.clear();
 }
 
+qint64 Buffer::queued() const {
+    return m_buffer.size();
+}
+
+
+Take::Take(int count, std::function<bool (const QVariant&)> accept, StreamBase* parent) :
+    Operator(parent), m_count(count) {
+    QObject::connect(m_parent, &StreamBase::next,  this, [this, accept](const QVariant & value) {
+        if(m_done) {
+            return;
+        }
+        bool accepted = true;
+        if(accept) {
+            CallbackScope scope(this);
+            accepted = accept(value);
+        }
+        if(!accepted) {
+            stop();
+            return;
+        }
+        ++m_taken;
+        emit next(value);
+        if(m_taken >= m_count) {
+            stop();
+        }
+    });
+    if(m_count <= 0) {
+        delayedCall([this]() {
+            stop();
+        });
+    }
+}
+
+void Take::stop() {
+    if(m_done) {
+        return;
+    }
+    m_done = true;
+    QObject::disconnect(m_parent, &StreamBase::next, this, nullptr); //anything still on its way is dropped
+    auto p = producer();
+    p->defer();     //timers are stopped now, not when complete has been through
+    p->complete();
+}
+
+void Take::cancel() {
+    m_done = true;
+}
+
+Skip::Skip(int count, std::function<bool (const QVariant&)> skip, StreamBase* parent) :
+    Operator(parent), m_count(count) {
+    QObject::connect(m_parent, &StreamBase::next,  this, [this, skip](const QVariant & value) {
+        if(m_skipping) {
+            if(m_count > 0) {
+                --m_count;
+                return;
+            }
+            if(skip) {
+                CallbackScope scope(this);
+                if(skip(value)) {
+                    return;
+                }
+            }
+            m_skipping = false;
+        }
+        emit next(value);
+    });
+}
+
 
 enum {Parent = 1, Child = 2};
 Split::Split(StreamBase* parent) : ParentStream(parent), m_nexts({QVariant(), QVariant()}) {
@@ -66,13 +144,14 @@ void Split::cancel() {
     m_child->cancel();
 }
 
-Scan::Scan(std::function<QVariant()> getAcc, std::function<void (const QVariant& variant)> scan, StreamBase* parent) : Operator(parent) {
-    QObject::connect(m_parent, &StreamBase::next,  this, [this, scan](const QVariant & value) {
+Scan::Scan(Callable<QVariant()> getAcc, Callable<void (const QVariant& variant)> scan, StreamBase* parent) : Operator(parent) {
+    QObject::connect(m_parent, &StreamBase::next,  this, [this, scan = std::move(scan)](const QVariant & value) {
         m_pending = true;
+        CallbackScope scope(this);
         scan(value);
     });
 
-    QObject::connect(m_parent, &StreamBase::finished, this, [this, getAcc](ProducerBase * origin) {
+    QObject::connect(m_parent, &StreamBase::finished, this, [this, getAcc = std::move(getAcc)](ProducerBase * origin) {
         Q_UNUSED(origin);
         if(m_pending) {
             m_pending = false;
@@ -101,8 +180,13 @@ Delay::Delay(StreamBase* parent, int ms)  : Operator(parent) {
     QObject::connect(m_parent, &StreamBase::next,  this, [delay, this](const QVariant & value) {
         ++m_onWait;
         auto timer = get(delay);
-        QObject::connect(timer, &QTimer::timeout, this, [this, value]() {
-            emit next(value);
+        const auto latency = LatencyScope::current();
+        QObject::connect(timer, &QTimer::timeout, this, [this, value, latency]() {
+            {
+                TraceScope trace("delay", this);
+                LatencyScope scope(latency);
+                emit next(value);
+            }
             --m_onWait;
             delayedCall([this]() {
                 if(m_onWait == 0) {
@@ -126,6 +210,10 @@ bool Delay::wait() const {
     return m_onWait > 0;
 }
 
+qint64 Delay::queued() const {
+    return m_onWait;
+}
+
 void Delay::cancel() {
     emit waitOver();
 }
@@ -156,6 +244,183 @@ QTimer* Delay::get(int delay) {
 }
 
 
+Throttle::Throttle(Mode mode, int ms, StreamBase* parent) : Operator(parent), m_mode(mode), m_timer(new QTimer(this)) {
+    Q_ASSERT(ms >= 0);
+    m_timer->setInterval(ms);
+    m_timer->setSingleShot(mode != Sample);
+    QObject::connect(m_timer, &QTimer::timeout, this, &Throttle::onTimeout);
+    QObject::connect(m_parent, &StreamBase::next,  this, [this](const QVariant & value) {
+        switch(m_mode) {
+        case Debounce:
+            hold(value);
+            m_timer->start(); //restart, the quiet period begins again
+            break;
+        case ThrottleFirst:
+            if(!m_timer->isActive()) {
+                emit next(value);
+                m_timer->start();
+            }
+            break;
+        case ThrottleLatest:
+            if(!m_timer->isActive()) {
+                emit next(value);
+                m_timer->start();
+            } else {
+                hold(value);
+            }
+            break;
+        case Sample:
+            hold(value);
+            if(!m_timer->isActive()) {
+                m_timer->start();
+            }
+            break;
+        }
+    });
+    //the window may still hold the latest value
+    QObject::connect(m_parent, &StreamBase::finished, this, [this](ProducerBase * origin) {
+        Q_UNUSED(origin);
+        flush();
+    });
+}
+
+void Throttle::hold(const QVariant& value) {
+    m_latest = value;
+    m_hasLatest = true;
+}
+
+void Throttle::onTimeout() {
+    if(m_hasLatest) {
+        m_hasLatest = false;
+        emit next(m_latest);
+        m_latest = QVariant();
+        if(m_mode == ThrottleLatest) {
+            m_timer->start(); //emitted value opens a new window
+        }
+    } else if(m_mode == Sample) {
+        m_timer->stop(); //nothing to sample, next input restarts
+    }
+}
+
+void Throttle::flush() {
+    m_timer->stop();
+    if(m_hasLatest) {
+        m_hasLatest = false;
+        emit next(m_latest);
+        m_latest = QVariant();
+    }
+    emit waitOver();
+}
+
+bool Throttle::wait() const {
+    return m_hasLatest;
+}
+
+void Throttle::cancel() {
+    m_timer->stop();
+    m_hasLatest = false;
+    m_latest = QVariant();
+    emit waitOver();
+}
+
+
+Writer::Writer(QIODevice* device, int bufferSize, int flushMs, qint64 maxPending, StreamBase* parent) : Operator(parent),
+    m_device(device), m_bufferSize(std::max(1, bufferSize)), m_maxPending(maxPending), m_timer(new QTimer(this)) {
+    m_buffer.reserve(m_bufferSize); //reserved buffer keeps its capacity over resize(0)
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(std::max(0, flushMs));
+    QObject::connect(m_timer, &QTimer::timeout, this, &Writer::flush);
+    QObject::connect(m_device, &QObject::destroyed, this, [this]() {
+        m_device = nullptr;
+        m_buffer.resize(0);
+    });
+    QObject::connect(m_device, &QIODevice::bytesWritten, this, &Writer::onWritten);
+    QObject::connect(m_parent, &StreamBase::next,  this, [this](const QVariant & value) {
+        write(value.toByteArray());
+        emit next(value);
+    });
+    //write out the partial buffer and whatever the device still queues
+    QObject::connect(m_parent, &StreamBase::finished, this, [this](ProducerBase * origin) {
+        Q_UNUSED(origin);
+        drain();
+    });
+}
+
+void Writer::write(const QByteArray& data) {
+    if(!m_device) {
+        return;
+    }
+    if(m_buffer.size() + data.size() > m_bufferSize) {
+        flush();
+    }
+    if(data.size() >= m_bufferSize) { //would not fit anyway
+        if(m_device->write(data) < 0) {
+            emit producer()->error(SimpleError(m_device->errorString(), -1));
+        }
+        checkPending();
+        return;
+    }
+    m_buffer.append(data);
+    if(!m_timer->isActive()) {
+        m_timer->start();
+    }
+}
+
+void Writer::flush() {
+    m_timer->stop();
+    if(!m_device || m_buffer.isEmpty()) {
+        return;
+    }
+    if(m_device->write(m_buffer) < 0) {
+        emit producer()->error(SimpleError(m_device->errorString(), -1));
+    }
+    m_buffer.resize(0);
+    checkPending();
+}
+
+void Writer::checkPending() {
+    if(m_maxPending > 0 && !m_deferred && m_device->isSequential() && m_device->bytesToWrite() > m_maxPending) {
+        m_deferred = true; //e.g. socket cannot keep up, hold the producer until written
+        producer()->defer();
+    }
+}
+
+void Writer::onWritten() {
+    const auto pending = m_device ? m_device->bytesToWrite() : 0;
+    if(m_deferred && pending <= m_maxPending / 2) {
+        m_deferred = false;
+        producer()->requestAgain();
+    }
+    if(m_draining && pending == 0) {
+        m_draining = false;
+        emit waitOver();
+    }
+}
+
+void Writer::drain() {
+    flush();
+    if(auto file = qobject_cast<QFileDevice*>(m_device)) {
+        file->flush();
+    }
+    if(m_device && m_device->bytesToWrite() > 0) {
+        m_draining = true;  //e.g. socket, waitOver when all written
+        return;
+    }
+    emit waitOver();
+}
+
+bool Writer::wait() const {
+    return !m_buffer.isEmpty() || (m_device && m_device->bytesToWrite() > 0);
+}
+
+void Writer::cancel() {
+    m_timer->stop();
+    m_buffer.resize(0);
+    m_draining = false;
+    emit waitOver();
+}
+
+
 Wait::Wait(StreamBase* parent) : Operator(parent) {
     QObject::connect(parent, &StreamBase::next, this, &StreamBase::next);
 }
@@ -168,3 +433,29 @@ void Wait::unwait() {
     emit waitOver();
 }
 
+
+LatencyProbe::LatencyProbe(const QString& name, StreamBase* parent) : Operator(parent),
+    m_name(name), m_histograms(Latency::histograms(name)) {
+    Latency::s_probes.fetch_add(1, std::memory_order_relaxed);
+    QObject::connect(m_parent, &StreamBase::next,  this, [this](const QVariant & value) {
+        auto& context = Latency::context();
+        if(context.origin > 0) {
+            const auto now = Latency::now();
+            m_histograms->endToEnd.record(now - context.origin);
+            m_histograms->stage.record(now - context.checkpoint);
+            context.checkpoint = now;
+        }
+        emit next(value);
+    });
+}
+
+LatencyProbe::~LatencyProbe() {
+    Latency::s_probes.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void LatencyProbe::appendStats(QVariantMap& stats) const {
+    stats.insert("latency", QVariantMap{
+        {"name", m_name},
+        {"endToEnd", m_histograms->endToEnd.stats()},
+        {"stage", m_histograms->stage.stats()}});
+}
@@ -0,0 +1,125 @@
+#include "axq_pool.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <QMutex>
+
+using namespace Axq;
+
+namespace {
+
+constexpr std::size_t Granularity = 16;    //malloc alignment is kept
+constexpr std::size_t MaxSize = 512;       //larger are just allocated
+constexpr int Classes = static_cast<int>(MaxSize / Granularity);
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+std::atomic<std::size_t> chunkCount{0};
+
+QMutex orphansMutex;
+FreeBlock* orphans[Classes] = {};   //lists of exited threads
+
+int sizeClass(std::size_t size) {
+    return static_cast<int>((size + Granularity - 1) / Granularity) - 1;
+}
+
+thread_local bool listsDestroyed = false;   //nodes may still be deleted at thread exit
+
+struct ThreadLists {
+    FreeBlock* free[Classes] = {};
+    ~ThreadLists() {
+        listsDestroyed = true;
+        QMutexLocker lock(&orphansMutex);
+        for(int c = 0; c < Classes; c++) {
+            while(free[c]) {
+                const auto block = free[c];
+                free[c] = block->next;
+                block->next = orphans[c];
+                orphans[c] = block;
+            }
+        }
+    }
+};
+
+thread_local ThreadLists lists;
+
+FreeBlock* refill(int c) {
+    {
+        QMutexLocker lock(&orphansMutex);
+        if(orphans[c]) {
+            const auto list = orphans[c];
+            orphans[c] = nullptr;
+            return list;
+        }
+    }
+    const auto size = (static_cast<std::size_t>(c) + 1) * Granularity;
+    const auto chunk = static_cast<char*>(std::malloc(NodePool::ChunkSize));
+    if(!chunk) {
+        return nullptr;
+    }
+    chunkCount.fetch_add(1, std::memory_order_relaxed);
+    FreeBlock* list = nullptr;
+    for(auto offset = (NodePool::ChunkSize / size - 1) * size; ; offset -= size) {
+        const auto block = reinterpret_cast<FreeBlock*>(chunk + offset);
+        block->next = list;
+        list = block;
+        if(offset == 0) {
+            break;
+        }
+    }
+    return list;
+}
+
+}
+
+void* NodePool::allocate(std::size_t size) {
+    if(size == 0 || size > MaxSize) {
+        return ::operator new(size);
+    }
+    const auto c = sizeClass(size);
+    if(listsDestroyed) {
+        QMutexLocker lock(&orphansMutex);
+        const auto block = orphans[c];
+        if(block) {
+            orphans[c] = block->next;
+            return block;
+        }
+        return ::operator new((static_cast<std::size_t>(c) + 1) * Granularity);  //may end up into lists
+    }
+    auto& list = lists.free[c];
+    if(!list) {
+        list = refill(c);
+        if(!list) {
+            throw std::bad_alloc();
+        }
+    }
+    const auto block = list;
+    list = block->next;
+    return block;
+}
+
+std::size_t NodePool::chunks() {
+    return chunkCount.load(std::memory_order_relaxed);
+}
+
+void NodePool::release(void* ptr, std::size_t size) {
+    if(!ptr) {
+        return;
+    }
+    if(size == 0 || size > MaxSize) {
+        ::operator delete(ptr);
+        return;
+    }
+    const auto c = sizeClass(size);
+    const auto block = static_cast<FreeBlock*>(ptr);
+    if(listsDestroyed) {
+        QMutexLocker lock(&orphansMutex);
+        block->next = orphans[c];
+        orphans[c] = block;
+        return;
+    }
+    block->next = lists.free[c];
+    lists.free[c] = block;
+}
@@ -1,5 +1,11 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <QThread>
 #include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QTimer>
 #include "axq_producer.h"
 
 #if defined(MEASURE_TIME) || defined(MEASURE_MEM)
@@ -57,6 +63,7 @@ void ProducerBase::initConnections() {
     }, Qt::QueuedConnection);
 
     QObject::connect(this, &StreamBase::error, this, [this](const Error & err) {
+        traceInstant("error", this);
         for(auto c : root()->children<ProducerBase>()) {
             c->atError(err);
         }
@@ -112,6 +119,7 @@ void ProducerBase::doCancel() {
 
 //All subclasses should call this, instead of direct emit
 void ProducerBase::complete() {
+    traceInstant("complete", this);
     emit finished(this);
 
     for(const auto& chld : children<StreamBase>()) {
@@ -139,7 +147,10 @@ QueueProducer::QueueProducer(StreamBase* parent) : ProducerBase(parent) {init();
 QueueProducer::QueueProducer(QObject* parent) : ProducerBase(parent) {init();}
 QueueProducer::QueueProducer(std::nullptr_t) : ProducerBase(nullptr) {init();}
 void QueueProducer::init() {
-    QObject::connect(this, &QueueProducer::push, this, &QueueProducer::next);
+    QObject::connect(this, &QueueProducer::push, this, [this](const QVariant & value) {
+        LatencyScope scope(m_stamps->take());
+        emit next(value);
+    });
     QObject::connect(this, &QueueProducer::doComplete, this, [this]() {
         complete();
     });
@@ -181,9 +192,29 @@ static QVariantList makeList(const QVariant& value) {
     return QVariantList();
 }
 
+static bool takeList(const QVariant& value, SpillList& list) {
+    if(value.userType() == qMetaTypeId<SpillList>()) {
+        list = value.value<SpillList>(); //not loaded into memory
+        return true;
+    }
+    const auto items = makeList(value);
+    if(items.isEmpty()) {
+        return false;
+    }
+    list = SpillList(items);
+    return true;
+}
+
 List::List(std::function<QVariant(const QVariant&)> concat, StreamBase* parent) :
-    ProducerBase(parent), m_container(new Container<QVariantList>(this)) {
-    QObject::connect(m_container, &StreamBase::next, this, &StreamBase::next);
+    ProducerBase(parent), m_container(new Container<SpillList>(this)) {
+    QObject::connect(m_container, &StreamBase::next, this, [this](const QVariant & value) {
+        const auto err = m_container->container().takeError();
+        if(!err.isEmpty()) {
+            emit error(SimpleError(err, -1, true)); //spilled file is not readable, rest cannot be found
+            return;
+        }
+        emit next(value);
+    });
 
     QObject::connect(m_container, &StreamBase::finished, this, [this](ProducerBase * origin) {
         if(origin != this) {
@@ -195,20 +226,20 @@ List::List(std::function<QVariant(const QVariant&)> concat, StreamBase* parent)
     if(concat) {
         QObject::connect(m_parent, &StreamBase::next,  this, [this, concat](const QVariant & value) {
             m_pending = false;
-            auto list = makeList(concat(value));
-            if(!list.isEmpty()) {
-                m_container->set(std::forward<QVariantList>(list));
+            SpillList list;
+            if(takeList(concat(value), list)) {
+                m_container->set(std::move(list));
             } else {
                 m_container->append(value);
             }
             m_container->request(0);
         });
     } else {
-        QObject::connect(m_parent, &StreamBase::next, this, [this, concat](const QVariant & value) {
+        QObject::connect(m_parent, &StreamBase::next, this, [this](const QVariant & value) {
             m_pending = false;
-            auto list = makeList(value);
-            if(!list.isEmpty()) {
-                m_container->set(std::forward<QVariantList>(list));
+            SpillList list;
+            if(takeList(value, list)) {
+                m_container->set(std::move(list));
             } else {
                 m_container->append(value);
             }
@@ -332,9 +363,9 @@ void Merge::cancel() {
 }
 
 
-Repeater::Repeater(RepeatFunction f, int ms, StreamBase* parent) : ProducerBase(parent) {init(f, ms);}
-Repeater::Repeater(RepeatFunction f, int ms, QObject* parent) : ProducerBase(parent) {init(f, ms);}
-Repeater::Repeater(RepeatFunction f, int ms, std::nullptr_t) : ProducerBase(nullptr) {init(f, ms);}
+Repeater::Repeater(RepeatFunction f, int ms, StreamBase* parent) : ProducerBase(parent) {init(std::move(f), ms);}
+Repeater::Repeater(RepeatFunction f, int ms, QObject* parent) : ProducerBase(parent) {init(std::move(f), ms);}
+Repeater::Repeater(RepeatFunction f, int ms, std::nullptr_t) : ProducerBase(nullptr) {init(std::move(f), ms);}
 
 void Repeater::complete() {
     m_timer->stop();
@@ -372,7 +403,7 @@ void Repeater::init(RepeatFunction f, int ms) {
             m_timer->stop();
         }
     });
-    QObject::connect(this, &Repeater::requestOne, [this, f]() {
+    QObject::connect(this, &Repeater::requestOne, [this, f = std::move(f)]() {
         emit next(f());
     });
 }
@@ -384,6 +415,8 @@ void Serializer :: init() {
     Q_ASSERT(!m_timer);
     m_timer = new QTimer(this);
     QObject::connect(this, &Serializer::requestOne, [this]() {
+        TraceScope trace("tick", this);
+        LatencyScope latency;
         onNext();
     });
 
@@ -451,11 +484,11 @@ void Serializer::request() {
     request(m_delay);
 }
 
-FuncProducer::FuncProducer(std::function<QVariant()> function, std::nullptr_t parent)  : Serializer(parent), m_f(function) {
+FuncProducer::FuncProducer(Callable<QVariant()> function, std::nullptr_t parent)  : Serializer(parent), m_f(std::move(function)) {
 }
-FuncProducer::FuncProducer(std::function<QVariant()> function, QObject* parent)  : Serializer(parent), m_f(function) {
+FuncProducer::FuncProducer(Callable<QVariant()> function, QObject* parent)  : Serializer(parent), m_f(std::move(function)) {
 }
-FuncProducer::FuncProducer(std::function<QVariant()> function, StreamBase* parent)  : Serializer(parent), m_f(function) {
+FuncProducer::FuncProducer(Callable<QVariant()> function, StreamBase* parent)  : Serializer(parent), m_f(std::move(function)) {
 }
 bool FuncProducer::hasData() const {
     Q_ASSERT(!parent());
@@ -465,9 +498,9 @@ void FuncProducer::request(int ms) {
     m_called = false;
     Serializer::request(ms);
 }
-void FuncProducer::set(std::function<QVariant()> function) {
+void FuncProducer::set(Callable<QVariant()> function) {
     m_called = function == nullptr;
-    m_f = function;
+    m_f = std::move(function);
     emit dataAdded();
 }
 void FuncProducer::cancel() {
@@ -492,3 +525,110 @@ void FuncProducer::onNext() {
 }
 
 
+
+
+namespace {
+
+constexpr int ReapMs = 1000;
+
+/*
+ * Mappings of deleted MappedFiles that still have views referenced, e.g. queued to a thread
+ * or collected by buffer. They are polled and unmapped when the last view is released.
+ */
+struct KeptMapping {
+    QFile* file;
+    uchar* data;
+    std::deque<QByteArray> views;
+};
+
+QMutex keptMutex;
+std::vector<KeptMapping> keptMappings;
+
+bool isReleased(std::deque<QByteArray>& views) {
+    views.erase(std::remove_if(views.begin(), views.end(), [](const QByteArray & view) {
+        return view.isDetached(); //only the copy here is left
+    }), views.end());
+    return views.empty();
+}
+
+void unmap(QFile* file, uchar* data) {
+    file->unmap(data);
+    delete file;
+}
+
+void reapMappings() {
+    QMutexLocker lock(&keptMutex);
+    keptMappings.erase(std::remove_if(keptMappings.begin(), keptMappings.end(), [](KeptMapping & kept) {
+        if(!isReleased(kept.views)) {
+            return false;
+        }
+        unmap(kept.file, kept.data);
+        return true;
+    }), keptMappings.end());
+    if(!keptMappings.empty() && QCoreApplication::instance()) {
+        QTimer::singleShot(ReapMs, QCoreApplication::instance(), &reapMappings);
+    }
+}
+
+}
+
+MappedFile::MappedFile(QFile* file, uchar* data, qint64 size, int len, std::nullptr_t) : Serializer(nullptr),
+    m_file(file), m_data(data), m_size(size), m_len(len) {
+    Q_ASSERT(m_data);
+    delayedCall([this]() {
+        if(!hasData()) {
+            complete();
+        }
+    });
+}
+
+MappedFile::~MappedFile() {
+    if(isReleased(m_views)) {
+        unmap(m_file, m_data);
+        return;
+    }
+    if(QCoreApplication::instance()) {
+        m_file->moveToThread(QCoreApplication::instance()->thread()); //deleted there by the reaper
+    }
+    QMutexLocker lock(&keptMutex);
+    keptMappings.push_back({m_file, m_data, std::move(m_views)});
+    if(keptMappings.size() == 1 && QCoreApplication::instance()) {
+        QTimer::singleShot(ReapMs, QCoreApplication::instance(), &reapMappings);
+    }
+}
+
+bool MappedFile::hasData() const {
+    return m_data && m_pos < m_size;
+}
+
+void MappedFile::cancel() {
+    m_pos = m_size;
+    ProducerBase::cancel();
+}
+
+void MappedFile::onNext() {
+    if(!hasData()) {
+        return;
+    }
+    const auto begin = reinterpret_cast<const char*>(m_data) + m_pos;
+    const auto left = m_size - m_pos;
+    qint64 len = left;
+    if(m_len == OneLine) {
+        const auto nl = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(left)));
+        if(nl) {
+            len = (nl - begin) + 1;
+        }
+    } else if(m_len > 0) {
+        len = std::min<qint64>(left, m_len);
+    }
+    len = std::min<qint64>(len, std::numeric_limits<int>::max()); //QByteArray cannot view more at once
+    m_pos += len;
+    while(!m_views.empty() && m_views.front().isDetached()) {
+        m_views.pop_front();
+    }
+    const auto view = QByteArray::fromRawData(begin, static_cast<int>(len));
+    emit next(view);
+    if(!view.isDetached()) {
+        m_views.push_back(view); //kept downstream, e.g. queued or collected
+    }
+}
@@ -134,10 +134,17 @@ QVariant EnvQML::iterator(const QJSValue& object) {
 
 StreamQML::StreamQML(EnvQML* env, StreamQML* parent) : QObject(parent), m_env(env), m_parent(parent) {
     m_env->qml().setObjectOwnership(this, QQmlEngine::CppOwnership);
+    m_accounted.begin(this);
+    if(m_accounted.begun()) {
+        StreamBase::delayedCall(this, [this]() {
+            m_accounted.classify(this, metaObject()->className()); //class is known only after construction
+        });
+    }
 }
 
 
 StreamQML::~StreamQML() {
+    m_accounted.end(this);
 }
 
 QVariant StreamQML::each(const QJSValue& caller) {
@@ -226,6 +233,26 @@ QVariant StreamQML::delay(int ms) {
 
 }
 
+QVariant StreamQML::debounce(int ms) {
+    const auto consumer = new ThrottleQML(Throttle::Debounce, ms, m_env, this);
+    return QVariant::fromValue<ThrottleQML*>(consumer);
+}
+
+QVariant StreamQML::throttleFirst(int ms) {
+    const auto consumer = new ThrottleQML(Throttle::ThrottleFirst, ms, m_env, this);
+    return QVariant::fromValue<ThrottleQML*>(consumer);
+}
+
+QVariant StreamQML::throttleLatest(int ms) {
+    const auto consumer = new ThrottleQML(Throttle::ThrottleLatest, ms, m_env, this);
+    return QVariant::fromValue<ThrottleQML*>(consumer);
+}
+
+QVariant StreamQML::sample(int ms) {
+    const auto consumer = new ThrottleQML(Throttle::Sample, ms, m_env, this);
+    return QVariant::fromValue<ThrottleQML*>(consumer);
+}
+
 void StreamQML::makeError(const QJSValue& error, int code, bool isFatal) {
     stream()->error(SimpleError(error.toVariant(), code, isFatal));
 }
@@ -277,6 +304,14 @@ StreamBase* DelayQML::stream() {
     return m_delay;
 }
 
+ThrottleQML::ThrottleQML(Throttle::Mode mode, int ms, EnvQML* env, StreamQML* parent) : StreamQML(env, parent),
+    m_throttle(new Axq::Throttle(mode, ms, parent->stream())) {
+}
+
+StreamBase* ThrottleQML::stream() {
+    return m_throttle;
+}
+
 QVariant StreamQML::wait(const QJSValue& caller) {
     return QVariant::fromValue<StreamQML*>(new WaitQML(caller, m_env, this));
 }
@@ -348,7 +383,7 @@ QVariant ProducerQML::request(int delay) {
 //RangeQML
 
 RangeQML::RangeQML(int begin, int end, int step, EnvQML* env, StreamQML* stream) :
-    ProducerQML(env, stream), m_range(new Range<QObject*>(begin, end, step, this)) {
+    ProducerQML(env, stream), m_range(new Range<int, QObject*>(begin, end, step, this)) {
     QObject::connect(m_range, &ProducerBase::completed, this, &ProducerQML::completed);
 }
 
@@ -403,7 +438,7 @@ StreamBase* QueueQML::stream() {
 }
 
 BufferQML::BufferQML(const QJSValue& max, EnvQML* env, StreamQML* parent) : StreamQML(env, parent),
-    m_buffer(new Buffer(max.toInt(), parent->stream())) {
+    m_buffer(new Buffer(max.toInt(), 0, parent->stream())) {
 
 }
 
@@ -0,0 +1,343 @@
+#include "axq_spill.h"
+#include "axq_codec.h"
+#include <QTemporaryFile>
+#include <QStringList>
+
+using namespace Axq;
+
+namespace {
+
+constexpr int FlushBytes = 0x100000;
+constexpr qint64 Overhead = static_cast<qint64>(sizeof(QVariant)) + 16;
+
+template <typename T>
+const T& at(const QVariant& value) {
+    return *static_cast<const T*>(value.constData());
+}
+
+qint64 approxSize(const QVariant& value) {
+    switch(value.userType()) {
+    case QMetaType::QString:
+        return Overhead + 2 * at<QString>(value).size();
+    case QMetaType::QByteArray:
+        return Overhead + at<QByteArray>(value).size();
+    case QMetaType::QStringList: {
+        qint64 size = Overhead;
+        for(const auto& s : at<QStringList>(value)) {
+            size += Overhead + 2 * s.size();
+        }
+        return size;
+    }
+    case QMetaType::QVariantList: {
+        qint64 size = Overhead;
+        for(const auto& v : at<QVariantList>(value)) {
+            size += approxSize(v);
+        }
+        return size;
+    }
+    case QMetaType::QVariantMap: {
+        const auto& map = at<QVariantMap>(value);
+        qint64 size = Overhead;
+        for(auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            size += Overhead + 2 * it.key().size() + approxSize(it.value());
+        }
+        return size;
+    }
+    default:
+        return Overhead;
+    }
+}
+
+void registerSpillList() {
+    qRegisterMetaType<Axq::SpillList>();
+    QMetaType::registerConverter<Axq::SpillList, QVariantList>(&Axq::SpillList::toList);
+}
+
+Q_CONSTRUCTOR_FUNCTION(registerSpillList)
+
+}
+
+struct SpillList::Data {
+    Data(qint64 spillBytes) : limit(spillBytes) {}
+    void spill();
+    void encode(const QVariant& value);
+    void flush();
+    bool write();
+    void abandon(const QString& reason);
+    void unspill(const QString& reason);
+    const char* read(qint64 offset, qint64& available);
+    qint64 limit;
+    qint64 count = 0;
+    QVariantList memory;
+    qint64 memoryBytes = 0;
+    std::unique_ptr<QTemporaryFile> file; //removed and unmapped with data
+    QByteArray pending;     //encoded, but not yet written
+    qint64 written = 0;
+    uchar* map = nullptr;
+    qint64 mapSize = 0;
+    QByteArray readBack;    //if mapping fails
+    qint64 readBackOffset = -1;
+    int generation = 0;
+    QString error;          //last failure, see takeError
+};
+
+void SpillList::Data::spill() {
+    file.reset(new QTemporaryFile());
+    if(!file->open()) {
+        abandon(QString("Cannot spill: %1").arg(file->errorString()));
+        return;
+    }
+    pending.reserve(FlushBytes); //reserved keeps its capacity over resize(0)
+    for(const auto& value : memory) {
+        if(!Codec::encode(value, pending)) {
+            abandon(QString("Cannot spill %1").arg(value.typeName()));
+            return;
+        }
+        if(pending.size() >= FlushBytes && !write()) {
+            abandon(QString("Cannot spill: %1").arg(file->errorString()));
+            return;
+        }
+    }
+    memory.clear();
+    memoryBytes = 0;
+    ++generation;
+}
+
+void SpillList::Data::encode(const QVariant& value) {
+    if(!Codec::encode(value, pending)) {
+        unspill(QString("Cannot spill %1").arg(value.typeName()));
+        memory.append(value);
+        ++count;
+        return;
+    }
+    ++count;
+    if(pending.size() >= FlushBytes) {
+        flush();
+    }
+}
+
+void SpillList::Data::flush() {
+    if(!write()) {
+        unspill(QString("Cannot spill: %1").arg(file->errorString()));
+    }
+}
+
+bool SpillList::Data::write() {
+    if(file->write(pending) != pending.size()) {
+        return false;   //pending is kept, written tells what is valid in file
+    }
+    written += pending.size();
+    pending.resize(0);
+    return true;
+}
+
+void SpillList::Data::abandon(const QString& reason) {
+    error = reason;
+    file.reset();   //memory is still intact
+    pending = QByteArray();
+    written = 0;
+    limit = 0;      //keep in memory then
+}
+
+void SpillList::Data::unspill(const QString& reason) {
+    error = reason;
+    QVariantList values;
+    qint64 offset = 0;
+    const auto end = written + pending.size();
+    while(offset < end) {
+        qint64 available;
+        const auto begin = read(offset, available);
+        auto pos = begin;
+        QVariant value;
+        if(available <= 0 || !Codec::decode(pos, begin + available, value)) {
+            error += QString(", %1 values lost").arg(count - values.size());
+            break;
+        }
+        values.append(value);
+        offset += pos - begin;
+    }
+    if(map) {
+        file->unmap(map);
+        map = nullptr;
+        mapSize = 0;
+    }
+    file.reset();
+    pending = QByteArray();
+    written = 0;
+    readBack = QByteArray();
+    readBackOffset = -1;
+    memory = values;
+    count = values.size();
+    limit = 0; //rest is kept in memory
+    ++generation;
+}
+
+const char* SpillList::Data::read(qint64 offset, qint64& available) {
+    if(offset >= written) {
+        const auto pos = static_cast<int>(offset - written);
+        available = pending.size() - pos;
+        return pending.constData() + pos;
+    }
+    if(mapSize < written) {
+        if(map) {
+            file->unmap(map);
+        }
+        file->flush();
+        map = file->map(0, written);
+        mapSize = map ? written : 0;
+    }
+    if(map) {
+        available = mapSize - offset;
+        return reinterpret_cast<const char*>(map) + offset;
+    }
+    if(readBackOffset < 0 || offset < readBackOffset || offset >= readBackOffset + readBack.size()) {
+        file->seek(offset); //mapping not available, read rest of file
+        readBack = file->read(written - offset);
+        readBackOffset = offset;
+    }
+    available = readBack.size() - (offset - readBackOffset);
+    return readBack.constData() + (offset - readBackOffset);
+}
+
+QVariant SpillList::const_iterator::operator*() const {
+    Q_ASSERT(m_data && m_index < m_data->count);
+    if(!m_data->file) {
+        return m_data->memory.at(static_cast<int>(m_index));
+    }
+    seek();
+    qint64 available;
+    const auto begin = m_data->read(m_offset, available);
+    auto pos = begin;
+    QVariant value;
+    if(available <= 0 || !Codec::decode(pos, begin + available, value)) {
+        m_data->error = QString("Cannot read spilled value at %1").arg(m_offset);
+    }
+    m_next = m_offset + (pos - begin);
+    return value;
+}
+
+SpillList::const_iterator& SpillList::const_iterator::operator++() {
+    if(m_data->file) {
+        if(m_next < 0) {
+            operator*();
+        }
+        m_offset = m_next;
+        m_next = -1;
+    }
+    ++m_index;
+    return *this;
+}
+
+void SpillList::const_iterator::seek() const {
+    if(m_generation == m_data->generation) {
+        return;
+    }
+    m_generation = m_data->generation; //spilled after iterator was created, find by index
+    m_offset = 0;
+    m_next = -1;
+    for(qint64 i = 0; i < m_index; i++) {
+        qint64 available;
+        const auto begin = m_data->read(m_offset, available);
+        auto pos = begin;
+        QVariant value;
+        Codec::decode(pos, begin + available, value);
+        m_offset += pos - begin;
+    }
+}
+
+SpillList::SpillList(qint64 spillBytes) : d(std::make_shared<Data>(spillBytes)) {
+}
+
+SpillList::SpillList(const QVariantList& list) : d(std::make_shared<Data>(0)) {
+    d->memory = list;
+    d->count = list.size();
+}
+
+void SpillList::detach() {
+    if(d.use_count() == 1) {
+        return;
+    }
+    if(!d->file) {
+        auto data = std::make_shared<Data>(d->limit);
+        data->memory = d->memory;
+        data->memoryBytes = d->memoryBytes;
+        data->count = d->count;
+        d = data;
+        return;
+    }
+    SpillList copy(d->limit);
+    for(auto it = constBegin(); it != constEnd(); ++it) {
+        copy.append(*it);
+    }
+    d = copy.d;
+}
+
+void SpillList::append(const QVariant& value) {
+    detach();
+    if(d->file) {
+        d->encode(value); //on failure values are moved back into memory
+        return;
+    }
+    ++d->count;
+    d->memory.append(value);
+    if(d->limit > 0) {
+        d->memoryBytes += approxSize(value);
+        if(d->memoryBytes > d->limit) {
+            d->spill();
+        }
+    }
+}
+
+bool SpillList::isEmpty() const {
+    return d->count == 0;
+}
+
+qint64 SpillList::size() const {
+    return d->count;
+}
+
+bool SpillList::isSpilled() const {
+    return d->file != nullptr;
+}
+
+void SpillList::clear() {
+    d = std::make_shared<Data>(d->limit);
+}
+
+SpillList::const_iterator SpillList::constBegin() const {
+    return const_iterator(d.get(), 0, d->generation);
+}
+
+SpillList::const_iterator SpillList::constEnd() const {
+    return const_iterator(d.get(), d->count, -1);
+}
+
+SpillList::const_iterator SpillList::rebind(const const_iterator& it) const {
+    if(it.m_data == d.get()) {
+        return it;
+    }
+    return const_iterator(d.get(), it.m_index, -1);
+}
+
+QString SpillList::takeError() {
+    QString error;
+    std::swap(error, d->error);
+    return error;
+}
+
+QVariantList SpillList::toList() const {
+    if(!d->file) {
+        return d->memory;
+    }
+    QVariantList list;
+    list.reserve(static_cast<int>(d->count));
+    for(auto it = constBegin(); it != constEnd(); ++it) {
+        list.append(*it);
+    }
+    return list;
+}
+
+void Axq::appendTo(SpillList& list, SpillList::const_iterator& it, const QVariant& value) {
+    list.append(value);
+    it = list.rebind(it); //index based, so stays valid unless detached
+}
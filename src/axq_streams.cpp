@@ -1,6 +1,7 @@
 
 #include "axq_streams.h"
 #include "axq_producer.h"
+#include "axq_graph.h"
 //#include "axq_singleton.h"
 
 #ifdef MEASURE_TIME
@@ -16,16 +17,21 @@ void Axq::Measure::elapsed(const QString& name) {
 #ifdef MEASURE_STREAMS
 #include "axq.h"
 #include <QDebug>
+#include <QMutex>
+QMutex global_streams_mutex;    //streams are created and deleted in async threads too
 QList<QSet<QObject*>> global_streams;
 void Axq::Measure::push() {
+    QMutexLocker lock(&global_streams_mutex);
     global_streams.append(QSet<QObject*>());
 }
 void Axq::Measure::alloc(QObject* obj) {
+    QMutexLocker lock(&global_streams_mutex);
     if(!global_streams.isEmpty()) {
         global_streams.last().insert(obj);
     }
 }
 void Axq::Measure::free(QObject* obj) {
+    QMutexLocker lock(&global_streams_mutex);
     if(!global_streams.isEmpty()) {
         global_streams.last().remove(obj);
     }
@@ -43,8 +49,10 @@ static QString objectsToList(QObject* o, QSet<QObject*>& parentList) {
     return "NULL";
 }
 void Axq::Measure::pop() {
+    QMutexLocker lock(&global_streams_mutex);
     if(!global_streams.isEmpty())
         QTimer::singleShot(0, []() {
+        QMutexLocker lock(&global_streams_mutex);
         QSet<QObject*> parentList;
         for(const auto& obj : global_streams.last()) {
             qWarning().noquote() << "Leak:" << obj << "->" << objectsToList(obj->parent(), parentList) << " on " << global_streams.length();
@@ -86,12 +94,14 @@ void StreamBase::connectFinished() {
 
 StreamBase::StreamBase(QObject* parent) : QObject(parent), m_parent(nullptr) {
     STREAM_ALLOC(this)
+    Graph::add(this);
     connectBaseHandlers();
 }
 
 StreamBase::StreamBase(std::nullptr_t parent) : QObject(nullptr), m_parent(nullptr) {
     Q_UNUSED(parent);
     STREAM_ALLOC(this)
+    Graph::add(this);
     connectBaseHandlers();
 }
 
@@ -110,7 +120,17 @@ void StreamBase::delayedCall(QObject* receiver, std::function<void ()> f) {
 
 void StreamBase::connectBaseHandlers() {
     QObject::connect(this, &QObject::destroyed, this, &StreamBase::waitOver); //ensure parent not keep waiting to complete
+    m_accounted.begin(this);
+    if(Trace::enabled()) { //completion handshake is traced only for streams created while tracing
+        QObject::connect(this, &StreamBase::finished, this, [this]() {
+            traceInstant("finished", this);
+        });
+        QObject::connect(this, &StreamBase::waitOver, this, [this]() {
+            traceInstant("waitOver", this);
+        });
+    }
     delayedCall([this]() {
+        m_accounted.classify(this, metaObject()->className()); //class is known only after construction
         initConnections();
     });
 }
@@ -157,8 +177,21 @@ void StreamBase::childEvent(QChildEvent* event) {
     QObject::childEvent(event);
 }
 
+bool StreamBase::event(QEvent* event) {
+    if(event->type() == QEvent::ThreadChange && Graph::remove(this)) {
+        //sent in the old thread, posted events move along, so this is registered in the new thread
+        QMetaObject::invokeMethod(this, [this]() {
+            Graph::add(this);
+        }, Qt::QueuedConnection);
+    }
+    return QObject::event(event);
+}
+
 
 StreamBase::~StreamBase() {
+    Metrics::release(this);
+    Graph::remove(this);
+    m_accounted.end(this);
     STREAM_FREE(this)
 }
 
@@ -186,6 +219,14 @@ bool StreamBase::wait() const {
 void StreamBase::cancel() {
 }
 
+qint64 StreamBase::queued() const {
+    return 0;
+}
+
+void StreamBase::appendStats(QVariantMap& stats) const {
+    Q_UNUSED(stats);
+}
+
 Error::~Error() {}
 
 QVariant SimpleError::error() const  {return m_error;}
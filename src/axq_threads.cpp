@@ -1,6 +1,7 @@
 #include "inc/axq_threads.h"
 #include <QFutureWatcher>
 #include <QtConcurrent>
+#include <algorithm>
 
 using namespace Axq;
 
@@ -18,6 +19,8 @@ AsyncProducer::AsyncProducer(ProducerBase* hosted, std::shared_ptr<StreamBase> o
     QObject::connect(hosted, &StreamBase::waitOver, this, &StreamBase::waitOver);
 
     QObject::connect(hosted, &StreamBase::next, this, [this](const QVariant & v) {
+        TraceScope trace("hop", this);
+        LatencyScope latency;   //latency context is per thread, restarted after the hop
         emit StreamBase::next(v);
     });
 
@@ -27,6 +30,7 @@ AsyncProducer::AsyncProducer(ProducerBase* hosted, std::shared_ptr<StreamBase> o
 
 
     QObject::connect(this, &AsyncProducer::requestSignal, hosted, [hosted, this](int ms) {
+        traceInstant("request", hosted);
         m_lastRequest = ms;
         hosted->request(ms);
     });
@@ -74,7 +78,10 @@ void AsyncProducer::complete() {
 
 void AsyncOp::appendChild(StreamBase* child) {
     m_childCount.insert(child);
-    QObject::connect(child, &StreamBase::next, this, [this](const QVariant & v) {
+    //hop back is done here, not by the watcher's children, so that the latency stamp is restarted once
+    QObject::connect(child, &StreamBase::next, m_watcher, [this](const QVariant & v) {
+        traceInstant("hop", m_watcher);
+        LatencyScope latency;
         emit m_watcher->StreamBase::next(v);
     });
     QObject::connect(child, &QObject::destroyed, this, [this](QObject * obj) {
@@ -121,6 +128,8 @@ AsyncWatcher::AsyncWatcher(StreamBase* parent) : Operator(parent), m_op(new Asyn
     auto ao = m_op.get(); //qobject_cast not working
 
     QObject::connect(m_parent, &StreamBase::next, ao, [ao](const QVariant & v) {
+        TraceScope trace("hop", ao);
+        LatencyScope latency;
         ao->AsyncOp::next(v);
     });
 
@@ -150,3 +159,139 @@ bool AsyncWatcher::wait() const {
 
 
 
+
+
+ReadAhead::ReadAhead(QIODevice* device, const QString& path, int chunkSize, int depth) : QObject(nullptr),
+    m_device(device), m_path(path), m_chunkSize(std::max(1, chunkSize)), m_ring(std::max(1, depth)) {
+    for(int i = 0; i < m_ring.size(); i++) {
+        m_free.append(i);
+    }
+    if(m_device) {
+        m_device->setParent(this); //moves to reading thread along
+    }
+}
+
+void ReadAhead::start() {
+    if(!m_device) {
+        m_device = new QFile(m_path, this);
+    }
+    if(!m_device->isOpen()) {
+        m_device->open(QIODevice::ReadOnly);
+    }
+    if(!m_device->isOpen()) {
+        end("Cannot open");
+        return;
+    }
+    if(m_device->isSequential()) { //read returns 0 until there is more, wait for it
+        QObject::connect(m_device, &QIODevice::readyRead, this, &ReadAhead::fill);
+        QObject::connect(m_device, &QIODevice::readChannelFinished, this, [this]() {
+            m_channelFinished = true;
+            fill();
+        });
+    }
+    fill();
+}
+
+void ReadAhead::release(int slot) {
+    m_free.append(slot);
+    fill();
+}
+
+void ReadAhead::fill() {
+    while(!m_ended && !m_free.isEmpty()) {
+        const int slot = m_free.takeFirst();
+        auto& buffer = m_ring[slot];
+        buffer.resize(m_chunkSize); //reuses the capacity, detaches only if the previous chunk is still referenced
+        const auto read = m_device->read(buffer.data(), m_chunkSize);
+        if(read < 0) {
+            m_free.prepend(slot);
+            end(m_device->errorString());
+            return;
+        }
+        if(read == 0) {
+            m_free.prepend(slot);
+            if(!m_device->isSequential() || m_channelFinished || !m_device->isOpen()) {
+                end(QString());
+            }
+            return;
+        }
+        buffer.resize(static_cast<int>(read));
+        emit chunk(slot, buffer);
+    }
+}
+
+void ReadAhead::end(const QString& error) {
+    m_ended = true;
+    emit ended(error);
+}
+
+AsyncRead::AsyncRead(ReadAhead* reader, std::nullptr_t) : Serializer(nullptr) {
+    reader->moveToThread(&m_thread);
+    QObject::connect(&m_thread, &QThread::started, reader, &ReadAhead::start);
+    QObject::connect(&m_thread, &QThread::finished, reader, &QObject::deleteLater);
+    QObject::connect(this, &AsyncRead::release, reader, &ReadAhead::release);
+    QObject::connect(reader, &ReadAhead::chunk, this, [this](int slot, const QByteArray & data) {
+        m_ready.enqueue({slot, data});
+        resume();
+    });
+    QObject::connect(reader, &ReadAhead::ended, this, [this](const QString & err) {
+        m_ended = true;
+        if(!err.isEmpty()) {
+            emit error(SimpleError(err, -1));
+        }
+        resume();
+    });
+    m_thread.start();
+}
+
+AsyncRead::~AsyncRead() {
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool AsyncRead::hasData() const {
+    return !m_ready.isEmpty() || !m_ended;
+}
+
+void AsyncRead::request(int milliseconds) {
+    m_pace = milliseconds;
+    m_starved = false;
+    Serializer::request(milliseconds);
+}
+
+void AsyncRead::defer() {
+    m_starved = false;
+    Serializer::defer();
+}
+
+qint64 AsyncRead::queued() const {
+    return m_ready.size();
+}
+
+void AsyncRead::cancel() {
+    m_ready.clear();
+    m_ended = true;
+    m_starved = false;
+    m_thread.quit();
+    Serializer::cancel();
+}
+
+void AsyncRead::resume() {
+    if(m_starved) {
+        request(m_pace);
+    }
+}
+
+void AsyncRead::onNext() {
+    if(m_ready.isEmpty()) {
+        if(!m_ended) {
+            m_starved = true;    // nothing prefetched, the timer is stopped until a chunk arrives
+            Serializer::defer();
+        }
+        return;
+    }
+    auto item = m_ready.dequeue();
+    emit next(item.second);
+    item.second = QByteArray(); //let go before release so the slot buffer is reused as is
+    emit release(item.first);
+}
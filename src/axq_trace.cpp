@@ -0,0 +1,162 @@
+#include "axq_trace.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QMutex>
+#include <QThread>
+
+using namespace Axq;
+
+namespace {
+
+constexpr int Capacity = 0x10000; //events per thread, when full the rest is dropped
+
+struct Event {
+    qint64 ns;
+    const char* name;
+    const char* type;
+    const QObject* stream;
+    char phase;
+};
+
+/*
+ * Written only by its own thread, count is published with release so that a reader
+ * sees complete events. Buffers are never freed as a reader may still use them, but the
+ * buffer of an exited thread is reused by the next new thread. It continues in the same
+ * lane, as the threads do not overlap in time.
+ */
+struct ThreadBuffer {
+    std::unique_ptr<Event[]> events{new Event[Capacity]};
+    std::atomic<int> count{0};
+    std::atomic<int> generation{-1};
+    std::atomic<quint64> dropped{0};
+    int tid = 0;
+    QByteArray name;
+};
+
+std::atomic<int> generation{0};
+std::atomic<qint64> startNs{0};
+QMutex buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+std::vector<ThreadBuffer*> idle;    //buffers of exited threads
+
+struct LocalBuffer {
+    ThreadBuffer* buffer = nullptr;
+    ~LocalBuffer() {
+        if(buffer) {
+            QMutexLocker lock(&buffersMutex);
+            idle.push_back(buffer);
+        }
+    }
+};
+
+thread_local LocalBuffer localBuffer;
+
+qint64 now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ThreadBuffer* buffer() {
+    if(!localBuffer.buffer) {
+        const auto thread = QThread::currentThread();
+        auto name = thread->objectName().toUtf8();
+        QMutexLocker lock(&buffersMutex);
+        ThreadBuffer* b;
+        if(!idle.empty()) {
+            b = idle.back();
+            idle.pop_back();
+        } else {
+            b = new ThreadBuffer();
+            b->tid = static_cast<int>(buffers.size()) + 1;
+            buffers.emplace_back(b);
+        }
+        if(name.isEmpty()) {
+            name = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread() ?
+                   QByteArray("main") : "thread " + QByteArray::number(b->tid);
+        }
+        b->name = name; //read only under the lock
+        localBuffer.buffer = b;
+    }
+    return localBuffer.buffer;
+}
+
+QByteArray escaped(QByteArray str) {
+    return str.replace('\\', "\\\\").replace('"', "\\\"");
+}
+
+}
+
+std::atomic<bool> Trace::s_enabled{false};
+
+void Trace::start() {
+    startNs.store(now(), std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_relaxed); //buffers reset themselves on their next record
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Trace::stop() {
+    s_enabled.store(false, std::memory_order_relaxed);
+}
+
+void Trace::record(Phase phase, const char* name, const QObject* stream) {
+    auto b = buffer();
+    const auto gen = generation.load(std::memory_order_relaxed);
+    if(b->generation.load(std::memory_order_relaxed) != gen) {
+        b->count.store(0, std::memory_order_relaxed);
+        b->dropped.store(0, std::memory_order_relaxed);
+        b->generation.store(gen, std::memory_order_release);
+    }
+    const auto index = b->count.load(std::memory_order_relaxed);
+    if(index >= Capacity) {
+        b->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    auto& event = b->events[index];
+    event.ns = now() - startNs.load(std::memory_order_relaxed);
+    event.name = name;
+    event.type = stream ? stream->metaObject()->className() : "";
+    event.stream = stream;
+    event.phase = phase;
+    b->count.store(index + 1, std::memory_order_release);
+}
+
+QByteArray Trace::json() {
+    const auto pid = QByteArray::number(QCoreApplication::applicationPid());
+    const auto gen = generation.load(std::memory_order_relaxed);
+    QByteArray out("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    QMutexLocker lock(&buffersMutex);
+    for(const auto& b : buffers) {
+        if(b->generation.load(std::memory_order_acquire) != gen) {
+            continue;
+        }
+        const auto tid = QByteArray::number(b->tid);
+        if(!first) {
+            out += ',';
+        }
+        first = false;
+        out += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid +
+               ",\"args\":{\"name\":\"" + escaped(b->name) + "\",\"dropped\":" +
+               QByteArray::number(b->dropped.load(std::memory_order_relaxed)) + "}}";
+        const auto count = b->count.load(std::memory_order_acquire);
+        for(int i = 0; i < count; i++) {
+            const auto& e = b->events[i];
+            out += ",\n{\"name\":\"";
+            out += e.name;
+            out += "\",\"cat\":\"axq\",\"ph\":\"";
+            out += e.phase;
+            out += "\",\"ts\":" + QByteArray::number(static_cast<double>(e.ns) / 1000.0, 'f', 3) +
+                   ",\"pid\":" + pid + ",\"tid\":" + tid;
+            if(e.phase == Instant) {
+                out += ",\"s\":\"t\"";
+            }
+            out += ",\"args\":{\"type\":\"";
+            out += e.type;
+            out += "\",\"stream\":\"0x" + QByteArray::number(reinterpret_cast<quintptr>(e.stream), 16) + "\"}}";
+        }
+    }
+    out += "]}\n";
+    return out;
+}
@@ -71,7 +71,7 @@ int FigmaImageProvider::count() const {
 
 std::shared_ptr<Axq::Stream> makeDataStream(QNetworkReply* reply) {
     auto queue = new Axq::Queue();
-    auto stream = std::shared_ptr<Axq::Stream>(new Axq::Stream(Axq::create(queue).buffer()));
+    auto stream = std::shared_ptr<Axq::Stream>(new Axq::Stream(Axq::create(queue)));
     QObject::connect(reply, &QNetworkReply::readyRead, [reply, queue](){
         queue->push(reply->readAll());
     });
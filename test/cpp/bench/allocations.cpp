@@ -0,0 +1,84 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "allocations.h"
+
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<quint64> allocations{0};
+std::atomic<quint64> bytes{0};
+std::atomic<quint64> events{0};
+
+void* allocate(std::size_t size) {
+    if(counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return std::malloc(size > 0 ? size : 1);
+}
+
+}
+
+void Allocations::start() {
+    allocations.store(0, std::memory_order_relaxed);
+    bytes.store(0, std::memory_order_relaxed);
+    events.store(0, std::memory_order_relaxed);
+    counting.store(true, std::memory_order_relaxed);
+}
+
+Allocations::Count Allocations::stop() {
+    counting.store(false, std::memory_order_relaxed);
+    Count count;
+    count.allocations = allocations.load(std::memory_order_relaxed);
+    count.bytes = bytes.load(std::memory_order_relaxed);
+    count.events = events.load(std::memory_order_relaxed);
+    return count;
+}
+
+void Allocations::countEvent() {
+    if(counting.load(std::memory_order_relaxed)) {
+        events.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Sized variants of the standard library call these, over-aligned allocations are not counted.
+void* operator new(std::size_t size) {
+    const auto ptr = allocate(size);
+    if(!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    const auto ptr = allocate(size);
+    if(!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
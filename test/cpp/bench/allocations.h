@@ -0,0 +1,25 @@
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <QtGlobal>
+
+/*
+ * Global operator new and delete of the benchmark are replaced to count allocations of the
+ * whole process, including Axq library, while counting is on. Events are counted by the
+ * application when delivered.
+ */
+namespace Allocations {
+
+struct Count {
+    quint64 allocations = 0;
+    quint64 bytes = 0;
+    quint64 events = 0;
+};
+
+void start();
+Count stop();
+void countEvent();
+
+}
+
+#endif // ALLOCATIONS_H
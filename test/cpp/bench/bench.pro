@@ -0,0 +1,17 @@
+QT -= gui
+QT += qml testlib
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+SOURCES += \
+        main.cpp \
+    benchmark.cpp \
+    allocations.cpp
+
+HEADERS += \
+    benchmark.h \
+    allocations.h
+
+include(../../../lib/Axq.pri)
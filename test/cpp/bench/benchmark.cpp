@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QTest>
+#include "benchmark.h"
+#include "allocations.h"
+
+namespace {
+
+constexpr int Items = 100000;
+constexpr int DelayItems = 10000;
+constexpr int Repeaters = 16;
+constexpr int BufferSize = 1000;
+constexpr double BudgetHeadroom = 1.1;  //recorded budget over measured
+
+void exec(Axq::Stream stream) {
+    QEventLoop loop;
+    stream.onCompleted([&loop]() {
+        loop.quit();
+    });
+    loop.exec();
+}
+
+quint64 createdNodes() {
+    quint64 created = 0;
+    for(const auto& c : Axq::accountingReport().value("classes").toMap()) {
+        created += c.toMap().value("created").toULongLong();
+    }
+    return created;
+}
+
+}
+
+void Benchmark::measure(const QString& name, int items, std::function<void(int)> run) {
+    qint64 ns = 0;
+    qint64 total = 0;
+    QBENCHMARK {
+        QElapsedTimer timer;
+        timer.start();
+        run(items);
+        ns += timer.nsecsElapsed();
+        total += items;
+    }
+    record(name, total, ns);
+    countAllocations(name, items, run);
+}
+
+void Benchmark::record(const QString& name, qint64 items, qint64 ns) {
+    QVariantMap result;
+    result.insert("name", name);
+    result.insert("items", items);
+    result.insert("ns", ns);
+    result.insert("itemsPerSec", ns > 0 ? static_cast<double>(items) * 1e9 / ns : 0.0);
+    result.insert("nsPerItem", items > 0 ? static_cast<double>(ns) / items : 0.0);
+    m_results.append(result);
+}
+
+/*
+ * Runs with half and full items, the difference is the cost per item: boxed values, queued
+ * events and other churn. What is left of the half run is the setup cost: nodes, their
+ * connections and callback captures. Node memory comes from the node pool that is not seen
+ * by counting, its growth is told by poolChunks.
+ */
+void Benchmark::countAllocations(const QString& name, int items, std::function<void(int)> run) {
+    const int half = items / 2;
+    Axq::setAccounting(true, 0);
+    const auto chunks = Axq::poolStats().value("chunks").toULongLong();
+    Allocations::start();
+    run(half);
+    const auto first = Allocations::stop();
+    const auto nodes = createdNodes();
+    Allocations::start();
+    run(items);
+    const auto second = Allocations::stop();
+    const auto nodesPerRun = createdNodes() - nodes;
+    const auto poolChunks = Axq::poolStats().value("chunks").toULongLong() - chunks;
+    Axq::setAccounting(false, 0);
+    const double n = items - half;
+    const auto perItem = [n](quint64 a, quint64 b) {
+        return std::max(0.0, (static_cast<double>(b) - static_cast<double>(a)) / n);
+    };
+    const auto allocsPerItem = perItem(first.allocations, second.allocations);
+    const auto bytesPerItem = perItem(first.bytes, second.bytes);
+    auto result = m_results.takeLast().toMap();
+    result.insert("allocsPerItem", allocsPerItem);
+    result.insert("bytesPerItem", bytesPerItem);
+    result.insert("eventsPerItem", perItem(first.events, second.events));
+    result.insert("setupAllocs", std::max(0.0, first.allocations - allocsPerItem * half));
+    result.insert("nodesPerRun", nodesPerRun);
+    result.insert("poolChunks", poolChunks);
+    m_results.append(result);
+    if(m_budget.contains(name)) {
+        const auto budget = m_budget.value(name).toMap();
+        const auto maxAllocs = budget.value("allocsPerItem").toDouble();
+        const auto maxBytes = budget.value("bytesPerItem").toDouble();
+        QVERIFY2(allocsPerItem <= maxAllocs, qPrintable(QString("%1 allocations per item, budget %2").arg(allocsPerItem).arg(maxAllocs)));
+        QVERIFY2(bytesPerItem <= maxBytes, qPrintable(QString("%1 bytes per item, budget %2").arg(bytesPerItem).arg(maxBytes)));
+    }
+}
+
+bool Benchmark::writeJson(const QString& path) const {
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QVariantMap root;
+    root.insert("qt", QString(qVersion()));
+#ifdef QT_DEBUG
+    root.insert("build", "debug");
+#else
+    root.insert("build", "release");
+#endif
+    root.insert("benchmarks", m_results);
+    return file.write(QJsonDocument::fromVariant(root).toJson()) > 0;
+}
+
+bool Benchmark::readBudget(const QString& path) {
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    m_budget = QJsonDocument::fromJson(file.readAll()).toVariant().toMap();
+    return true;
+}
+
+bool Benchmark::writeBudget(const QString& path) const {
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QVariantMap budget;
+    for(const auto& r : m_results) {
+        const auto result = r.toMap();
+        budget.insert(result.value("name").toString(), QVariantMap{
+            {"allocsPerItem", result.value("allocsPerItem").toDouble() * BudgetHeadroom},
+            {"bytesPerItem", result.value("bytesPerItem").toDouble() * BudgetHeadroom}});
+    }
+    return file.write(QJsonDocument::fromVariant(budget).toJson()) > 0;
+}
+
+void Benchmark::pipeline() {
+    measure("pipeline", Items, [](int items) {
+        exec(Axq::range(0, items)
+             .map<int, int>([](int v) {
+            return v + 1;
+        })
+        .filter<int>([](int v) {
+            return v % 2 == 0;
+        })
+        .each<int>([](int) {}));
+    });
+}
+
+void Benchmark::container() {
+    QList<int> values;
+    for(int i = 0; i < Items; i++) {
+        values.append(i);
+    }
+    const auto half = values.mid(0, Items / 2); //copied here so that not counted as allocations of a run
+    measure("container", Items, [values, half](int items) {
+        exec(Axq::from(items == half.size() ? half : values).each<int>([](int) {}));
+    });
+}
+
+void Benchmark::mergeRepeaters() {
+    measure("mergeRepeaters", Items / 10, [](int items) {
+        QList<Axq::Stream> streams;
+        for(int i = 0; i < Repeaters; i++) {
+            streams.append(Axq::repeater(0, i));
+        }
+        exec(Axq::merge(streams)
+             .meta<int, Axq::Stream::Index>([](int, ulong index) {
+            return static_cast<int>(index);
+        })
+        .completeEach<int>([items](int index) {
+            return index >= items - 1;
+        }));
+    });
+}
+
+void Benchmark::asyncHop() {
+    measure("asyncHop", Items / 10, [](int items) {
+        exec(Axq::range(0, items)
+             .async(&Axq::Stream::map<int, int>, [](int v) {
+            return v + 1;
+        })
+        .each<int>([](int) {}));
+    });
+}
+
+void Benchmark::delayScale() {
+    measure("delay", DelayItems, [](int items) {
+        exec(Axq::range(0, items)
+             .delay(1)
+             .each<int>([](int) {}));
+    });
+}
+
+void Benchmark::bufferFlush() {
+    measure("buffer", Items, [](int items) {
+        exec(Axq::range(0, items)
+             .buffer(BufferSize)
+             .iterate()
+             .each<int>([](int) {}));
+    });
+}
+
+void Benchmark::qmlCallback() {
+    QQmlEngine engine;
+    Axq::registerTypes();
+    QQmlComponent component(&engine);
+    component.setData("import QtQml 2.0\n"
+                      "import Axq 1.0\n"
+                      "QtObject {\n"
+                      "    signal done()\n"
+                      "    function run(count) {\n"
+                      "        Axq.range(0, count)\n"
+                      "        .map(function(v) { return v + 1 })\n"
+                      "        .each(function(v) {})\n"
+                      "        .onComplete(function() { done() })\n"
+                      "    }\n"
+                      "}\n", QUrl());
+    QScopedPointer<QObject> object(component.create());
+    QVERIFY2(object, qPrintable(component.errorString()));
+    const auto target = object.data();
+    measure("qmlCallback", Items / 10, [target](int items) {
+        QEventLoop loop;
+        QObject::connect(target, SIGNAL(done()), &loop, SLOT(quit()));
+        QMetaObject::invokeMethod(target, "run", Q_ARG(QVariant, items));
+        loop.exec();
+    });
+}
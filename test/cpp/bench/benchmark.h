@@ -0,0 +1,37 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <functional>
+#include <QObject>
+#include <QVariant>
+#include "axq.h"
+
+/*
+ * Fixed size scenarios of the engine, each measured with QBENCHMARK and recorded as items per second
+ * so that results can be compared between builds, see writeJson. Each scenario is also run with
+ * allocation counting, and it fails if its allocations per item exceed its budget.
+ */
+class Benchmark : public QObject {
+    Q_OBJECT
+public:
+    bool writeJson(const QString& path) const;
+    bool readBudget(const QString& path);
+    bool writeBudget(const QString& path) const;
+private slots:
+    void pipeline();
+    void container();
+    void mergeRepeaters();
+    void asyncHop();
+    void delayScale();
+    void bufferFlush();
+    void qmlCallback();
+private:
+    void measure(const QString& name, int items, std::function<void(int)> run);
+    void record(const QString& name, qint64 items, qint64 ns);
+    void countAllocations(const QString& name, int items, std::function<void(int)> run);
+private:
+    QVariantList m_results;
+    QVariantMap m_budget;
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,53 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QTest>
+#include "benchmark.h"
+#include "allocations.h"
+
+class Application : public QCoreApplication {
+public:
+    Application(int& argc, char** argv) : QCoreApplication(argc, argv) {}
+    bool notify(QObject* receiver, QEvent* event) Q_DECL_OVERRIDE {
+        Allocations::countEvent();
+        return QCoreApplication::notify(receiver, event);
+    }
+};
+
+static QString takeOption(QStringList& args, const QString& name) {
+    const auto index = args.indexOf(name);
+    if(index > 0 && index + 1 < args.size()) {
+        const auto value = args.at(index + 1);
+        args.erase(args.begin() + index, args.begin() + index + 2);
+        return value;
+    }
+    return QString();
+}
+
+/*
+ * Accepts QTest arguments and
+ * "--json <file>" that writes the results for regression tracking,
+ * "--budget <file>" that fails scenarios exceeding the allocations per item read from file,
+ * "--record-budget <file>" that writes the current allocations per item, with headroom, as budget.
+ */
+int main(int argc, char *argv[]){
+    Application a(argc, argv);
+    auto args = a.arguments();
+    const auto json = takeOption(args, "--json");
+    const auto budget = takeOption(args, "--budget");
+    const auto recordBudget = takeOption(args, "--record-budget");
+    Benchmark bench;
+    if(!budget.isEmpty() && !bench.readBudget(budget)) {
+        qWarning() << "Cannot read" << budget;
+        return 1;
+    }
+    auto status = QTest::qExec(&bench, args);
+    if(!json.isEmpty() && !bench.writeJson(json)) {
+        qWarning() << "Cannot write" << json;
+        status = status ? status : 1;
+    }
+    if(!recordBudget.isEmpty() && !bench.writeBudget(recordBudget)) {
+        qWarning() << "Cannot write" << recordBudget;
+        status = status ? status : 1;
+    }
+    return status;
+}
@@ -1,17 +1,25 @@
 #include <random>
 #include <algorithm>
 #include <vector>
+#include <numeric>
+#include <array>
+#include <memory>
 #include <QRegularExpression>
 #include <QCoreApplication>
 #include <QTextStream>
 #include <QTimer>
 #include <QFile>
+#include <QTemporaryFile>
+#include <QTemporaryDir>
 #include <QThread>
 #include <QMetaMethod>
 #include <QTime>
+#include <QDate>
+#include <QJsonDocument>
 #include <QVector>
 #include "unittest.h"
 #include "axq.h"
+#include "axq_codec.h"
 
 #include <QDebug>
 
@@ -801,3 +809,754 @@ void UnitTest::test_complete() {
         next();
     });
 }
+
+void UnitTest::test_throttle() {
+    STREAM_START_MEM;
+    expectTest("debounce: 9 throttleFirst: 0 throttleLatest: 0 9 sample: 9");
+    const auto append = [this](int v) {
+        appendTest(" ", v);
+    };
+    appendTest("debounce:");
+    Axq::range(0, 10).debounce(100).each<int>(append).onCompleted([this, append]() {
+        appendTest(" throttleFirst:");
+        Axq::range(0, 10).throttleFirst(1000).each<int>(append).onCompleted([this, append]() {
+            appendTest(" throttleLatest:");
+            Axq::range(0, 10).throttleLatest(1000).each<int>(append).onCompleted([this, append]() {
+                appendTest(" sample:");
+                Axq::range(0, 10).sample(1000).each<int>(append).onCompleted([this]() {
+                    print("\n");
+                    verifyTest();
+                    STREAM_CHECK_MEM;
+                    next();
+                });
+            });
+        });
+    });
+}
+
+void UnitTest::test_take() {
+    STREAM_START_MEM;
+    expectTest("limit: 5 6 7 8 9 10 11 12 13 14 processed: 15 while: 3 4 5 first: 0 last: 99");
+    const auto append = [this](int v) {
+        appendTest(" ", v);
+    };
+    auto processed = new int(0);
+    appendTest("limit:");
+    Axq::range(0, 1000000).each<int>([processed](int) {
+        ++(*processed);
+    }).skip(5).limit(10).each<int>(append)
+    .own(processed)
+    .onCompleted([this, append, processed]() {
+        appendTest(" processed: ", *processed, " while:");
+        Axq::range(0, 100).skipWhile<int>([](int v) {
+            return v < 3;
+        }).takeWhile<int>([](int v) {
+            return v < 6;
+        }).each<int>(append).onCompleted([this, append]() {
+            appendTest(" first:");
+            Axq::range(0, 100).first().each<int>(append).onCompleted([this, append]() {
+                appendTest(" last:");
+                Axq::range(0, 100).last().each<int>(append).onCompleted([this]() {
+                    print("\n");
+                    verifyTest();
+                    STREAM_CHECK_MEM;
+                    next();
+                });
+            });
+        });
+    });
+}
+
+void UnitTest::test_readMapped() {
+    STREAM_START_MEM;
+    expectTest("lines: alpha beta gamma records: abcd efgh ij kept: abcdefghij");
+    const auto tempFile = [](const QByteArray & content) {
+        auto file = new QTemporaryFile;
+        file->open();
+        file->write(content);
+        file->close();
+        return file;
+    };
+    const auto append = [this](const QByteArray & view) {
+        appendTest(" ", QString::fromLatin1(view).trimmed());
+    };
+    appendTest("lines:");
+    Axq::readMapped(tempFile("alpha\nbeta\ngamma")).each<QByteArray>(append).onCompleted([this, tempFile, append]() {
+        appendTest(" records:");
+        auto kept = new QList<QByteArray>;
+        Axq::readMapped(tempFile("abcdefghij"), 4).each<QByteArray>(append).each<QByteArray>([kept](const QByteArray & view) {
+            kept->append(view);
+        }).onCompleted([this, kept]() {
+            QTimer::singleShot(200, this, [this, kept]() { //views outlive the Stream
+                appendTest(" kept: ", QString::fromLatin1(kept->join()));
+                delete kept;
+                print("\n");
+                verifyTest();
+                STREAM_CHECK_MEM;
+                next();
+            });
+        });
+    });
+}
+
+void UnitTest::test_lines() {
+    STREAM_START_MEM;
+    expectTest("read: one two <> three split: one two three");
+    auto file = new QTemporaryFile;
+    file->open();
+    file->write("one\ntwo\n\nthree");
+    file->close();
+    const auto append = [this](const Axq::Lines & lines) {
+        for(const auto& line : lines.toList()) {
+            appendTest(" ", line.isEmpty() ? QString("<>") : QString::fromLatin1(line));
+        }
+    };
+    appendTest("read:");
+    Axq::lines(file, 4).each<Axq::Lines>(append).onCompleted([this, append]() {
+        appendTest(" split:");
+        Axq::from(QList<QByteArray>{"on", "e\ntw", "o\nthr", "ee"}).lines().each<Axq::Lines>(append).onCompleted([this]() {
+            print("\n");
+            verifyTest();
+            STREAM_CHECK_MEM;
+            next();
+        });
+    });
+}
+
+void UnitTest::test_asyncRead() {
+    STREAM_START_MEM;
+    expectTest("path: 10000/10 device: 10000/3");
+    auto file = new QTemporaryFile(this);
+    file->open();
+    file->write(QByteArray(10000, 'x'));
+    file->close();
+    const auto path = file->fileName();
+    auto sizes = new QList<int>;
+    const auto append = [sizes](const QByteArray & chunk) {
+        sizes->append(chunk.size());
+    };
+    const auto total = [this, sizes]() {
+        appendTest(" ", std::accumulate(sizes->begin(), sizes->end(), 0), "/", sizes->size());
+        sizes->clear();
+    };
+    appendTest("path:");
+    Axq::asyncRead(path, 1000, 3).each<QByteArray>(append).onCompleted([this, append, total, path, file, sizes]() {
+        total();
+        appendTest(" device:");
+        Axq::asyncRead(new QFile(path), 4000).each<QByteArray>(append).own(sizes).onCompleted([this, total, file]() {
+            total();
+            print("\n");
+            verifyTest();
+            file->deleteLater();
+            STREAM_CHECK_MEM;
+            next();
+        });
+    });
+}
+
+void UnitTest::test_writeTo() {
+    STREAM_START_MEM;
+    expectTest("written:0,1,2,3,4,5,6,7,8,9 passed:10");
+    auto file = new QTemporaryFile(this);
+    file->open();
+    file->close();
+    auto count = new int(0);
+    Axq::range(0, 10)
+    .map<QByteArray, int>([](int v) {
+        return QByteArray::number(v) + ',';
+    })
+    .writeTo(file, 8)
+    .each<QByteArray>([count](const QByteArray&) {
+        ++*count;
+    })
+    .own(count)
+    .onCompleted([this, file, count]() {
+        file->close();
+        file->open();
+        const auto out = QString("written:%1 passed:%2").arg(QString::fromLatin1(file->readAll().chopped(1))).arg(*count);
+        file->deleteLater();
+        print(out, "\n");
+        appendTest(out);
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_onBufferCompleted() {
+    STREAM_START_MEM;
+    expectTest("alpha,beta,gamma");
+    Axq::from(QList<QByteArray>{"alpha,", "beta,", "gamma"})
+    .onBufferCompleted([this](const QByteArray & bytes) {
+        const auto out = QString::fromLatin1(bytes);
+        print(out, "\n");
+        appendTest(out);
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    }, 16);
+}
+
+void UnitTest::test_localSocket() {
+    STREAM_START_MEM;
+    expectTest("0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19");
+    const QString name("axq_unittest_socket");
+    Axq::merge({
+        Axq::range(0, 20).toLocalSocket(name, 4),
+        Axq::fromLocalSocket(name, 4).each<int>([this](int v) {
+            appendTest(QString("%1%2").arg(v > 0 ? "," : "").arg(v));
+        })
+    })
+    .onCompleted([this]() {
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_codec() {
+    STREAM_START_MEM;
+    const QVariantList values{
+        true,
+        -42,
+        QVariant::fromValue<ulong>(1ul << 20),
+        Q_INT64_C(-1125899906842624),
+        3.25,
+        QString::fromLatin1("latin \xe4"),
+        QString::fromUtf8("unicode \xe2\x82\xac"),
+        QByteArray("\0bytes", 6),
+        QStringList{"a", "b"},
+        QVariantList{1, 2, 3, 4, 5},
+        QVariantList{0.5, 1.5, 2.5, 3.5},
+        QVariantList{1, "two", 3.0},
+        QVariantMap{{"key", 1}, {"nested", QVariantList{"x", 2}}},
+        QDate(2020, 2, 29)
+    };
+    expectTest(QString("ok").repeated(values.size()) + "tuple");
+    auto buffer = new QByteArray;
+    Axq::from(values)
+    .own(buffer)
+    .each<QVariant>([this, buffer](const QVariant & value) {
+        buffer->resize(0);
+        const bool encoded = Axq::Codec::encode(value, *buffer);
+        auto pos = buffer->constData();
+        QVariant decoded;
+        const bool ok = encoded && Axq::Codec::decode(pos, pos + buffer->size(), decoded)
+                        && pos == buffer->constData() + buffer->size()
+                        && decoded.userType() == value.userType() && decoded == value;
+        appendTest(ok ? "ok" : QString("fail:%1").arg(value.typeName()));
+    })
+    .onCompleted([this]() {
+        QByteArray bytes; //a Tuple is read back as QVariantList
+        Axq::Codec::encode(QVariant::fromValue(Axq::Tuple(std::make_tuple(1, QString("a")))), bytes);
+        appendTest(Axq::Codec::decode(bytes) == QVariantList{1, "a"} ? "tuple" : "fail:tuple");
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_spill() {
+    STREAM_START_MEM;
+    expectTest("spilled:1 count:2000 ordered:1");
+    auto state = new QList<int>{0, 0, 1}; //spilled, count, ordered
+    Axq::range(0, 2000)
+    .map<QString, int>([](int v) {
+        return QString("value %1").arg(v);
+    })
+    .buffer(100000, 4096)
+    .each<QVariant>([state](const QVariant & buffer) {
+        (*state)[0] = buffer.userType() != QMetaType::QVariantList;
+    })
+    .iterate()
+    .each<QString>([state](const QString & value) {
+        if(value != QString("value %1").arg((*state)[1])) {
+            (*state)[2] = 0;
+        }
+        ++(*state)[1];
+    })
+    .own(state)
+    .onCompleted([this, state]() {
+        const auto out = QString("spilled:%1 count:%2 ordered:%3").arg(state->at(0)).arg(state->at(1)).arg(state->at(2));
+        print(out, "\n");
+        appendTest(out);
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_spillError() {
+    STREAM_START_MEM;
+    expectTest("error:Cannot spill spilled:0 count:100");
+    QVariantList values;
+    for(int i = 0; i < 100; i++) {
+        values.append(i == 50 ? QVariant::fromValue<std::vector<bool>*>(nullptr) : QVariant(QString("value %1").arg(i)));
+    }
+    auto state = new QList<int>{0, 0}; //spilled, count
+    Axq::from(std::move(values))
+    .buffer(1000, 512)
+    .each<QVariant>([state](const QVariant & buffer) {
+        (*state)[0] = buffer.userType() != QMetaType::QVariantList;
+    })
+    .iterate()
+    .each<QVariant>([state](const QVariant&) {
+        ++(*state)[1];
+    })
+    .own(state)
+    .onError<QString>([this](const QString & err, int) {
+        appendTest("error:", err.section(' ', 0, 1), " ");
+    })
+    .onCompleted([this, state]() {
+        appendTest("spilled:", state->at(0), " count:", state->at(1));
+        print("\n");
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_journal() {
+    STREAM_START_MEM;
+    expectTest("4,5,6,7,8,9");
+    auto dir = new QTemporaryDir;
+    const auto path = dir->filePath("test");
+    Axq::range(0, 10)
+    .map<QString, int>([](int v) {
+        return QString("value %1").arg(v);
+    })
+    .journal(path, 0, 64)
+    .onCompleted([this, path, dir]() {
+        auto out = new QStringList;
+        Axq::replay(path, 4)
+        .each<QString>([out](const QString & value) {
+            out->append(value.mid(6));
+        })
+        .own(out)
+        .own(dir)
+        .onCompleted([this, out]() {
+            print(out->join(','), "\n");
+            appendTest(out->join(','));
+            verifyTest();
+            STREAM_CHECK_MEM;
+            next();
+        });
+    });
+}
+
+void UnitTest::test_blocks() {
+    STREAM_START_MEM;
+    expectTest("blocks:10 sum:49995000 parts:49995000");
+    auto values = new std::vector<int>(10000);
+    std::iota(values->begin(), values->end(), 0);
+    auto state = new QList<qint64>{0, 0, 0}; //blocks, sum, sum of parts
+    Axq::blocks<int>(values->cbegin(), values->cend(), 1000)
+    .each<QVector<int>>([state](const QVector<int>& block) {
+        ++(*state)[0];
+        (*state)[1] += std::accumulate(block.begin(), block.end(), qint64(0));
+    })
+    .onCompleted([this, values, state]() {
+        Axq::merge(Axq::partition<int>(values->cbegin(), values->cend(), 3, 500))
+        .iterate()
+        .each<int>([state](int value) {
+            (*state)[2] += value;
+        })
+        .own(values)
+        .own(state)
+        .onCompleted([this, state]() {
+            const auto out = QString("blocks:%1 sum:%2 parts:%3").arg(state->at(0)).arg(state->at(1)).arg(state->at(2));
+            print(out, "\n");
+            appendTest(out);
+            verifyTest();
+            STREAM_CHECK_MEM;
+            next();
+        });
+    });
+}
+
+void UnitTest::test_rangeTypes() {
+    STREAM_START_MEM;
+    expectTest("3000000000,3000000001,3000000002 0,0.25,0.5,0.75 10,7,4,1 blocks:3 sum:4999950000");
+    auto out = new QStringList;
+    auto state = new QList<qint64>{0, 0}; //blocks, sum
+    Axq::merge({
+        Axq::range<qint64>(3000000000, 3000000003).each<qint64>([out](qint64 v) {
+            out->append(QString::number(v));
+        }),
+        Axq::range(0.0, 1.0, 0.25).each<double>([out](double v) {
+            out->append(QString::number(v));
+        }),
+        Axq::range<qint64>(10, 0, -3).each<qint64>([out](qint64 v) {
+            out->append(QString::number(v));
+        }),
+        Axq::rangeBlocks<qint64>(0, 100000, 1, 40000).each<QVector<qint64>>([state](const QVector<qint64>& block) {
+            ++(*state)[0];
+            (*state)[1] += std::accumulate(block.begin(), block.end(), qint64(0));
+        })
+    })
+    .own(out)
+    .own(state)
+    .onCompleted([this, out, state]() {
+        QStringList ranges; //merge interleaves, so order by producer
+        ranges << out->filter(QRegularExpression("^3000")).join(',');
+        ranges << out->filter(QRegularExpression("^0")).join(',');
+        ranges << out->filter(QRegularExpression("^(10|7|4|1)$")).join(',');
+        ranges << QString("blocks:%1 sum:%2").arg(state->at(0)).arg(state->at(1));
+        print(ranges.join(' '), "\n");
+        appendTest(ranges.join(' '));
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_fromMove() {
+    STREAM_START_MEM;
+    expectTest("a,b,c 1,2,3 sum:4999950000");
+    auto out = new QStringList;
+    auto sum = new qint64(0);
+    std::vector<QString> strings{"a", "b", "c"};
+    QVariantList variants{1, 2, 3};
+    QVector<qint64> large(100000);
+    std::iota(large.begin(), large.end(), 0);
+    Axq::from(std::move(strings))
+    .each<QString>([out](const QString & v) {
+        out->append(v);
+    })
+    .onCompleted([this, out, sum, variants, large]() mutable {
+        out->append(" ");
+        Axq::merge({
+            Axq::from(std::move(variants)).each<int>([out](int v) {
+                out->append(QString::number(v));
+            }),
+            Axq::from(std::move(large)).each<qint64>([sum](qint64 v) {
+                *sum += v;
+            })
+        })
+        .own(out)
+        .own(sum)
+        .onCompleted([this, out, sum]() {
+            const auto result = QString("%1,%2,%3 %4,%5,%6 sum:%7").arg(out->at(0), out->at(1), out->at(2), out->at(4), out->at(5), out->at(6)).arg(*sum);
+            print(result, "\n");
+            appendTest(result);
+            verifyTest();
+            STREAM_CHECK_MEM;
+            next();
+        });
+    });
+}
+
+void UnitTest::test_converter() {
+    STREAM_START_MEM;
+    expectTest("1,2,3,4,5 sum:6");
+    auto out = new QStringList;
+    auto sum = new int(0);
+    Axq::from(QVariantList{1, "2", 3, QString("4"), 5})
+    .each<int>([out](int v) {
+        out->append(QString::number(v));
+    })
+    .onCompleted([this, out, sum]() {
+        Axq::from(QVariantList{QVariant(QVariantList{1, 2}), QVariant(QVariantList{3})})
+        .each<QList<int>>([sum](const QList<int>& v) {
+            *sum = std::accumulate(v.begin(), v.end(), *sum);
+        })
+        .own(out)
+        .own(sum)
+        .onCompleted([this, out, sum]() {
+            const auto result = QString("%1 sum:%2").arg(out->join(',')).arg(*sum);
+            print(result, "\n");
+            appendTest(result);
+            verifyTest();
+            STREAM_CHECK_MEM;
+            next();
+        });
+    });
+}
+
+void UnitTest::test_tuple() {
+    STREAM_START_MEM;
+    expectTest("a:1 bb:2 ccc:3 a,1 bb,2 ccc,3");
+    auto out = new QStringList;
+    using Pair = std::tuple<QString, int>;
+    auto pairs = Axq::from(QStringList{"a", "bb", "ccc"})
+    .map<Pair, QString>([](const QString & s) {
+        return std::make_tuple(s, s.length());
+    });
+    pairs.each<Pair>([out](const Pair & pair) {
+        out->append(QString("%1:%2").arg(std::get<0>(pair)).arg(std::get<1>(pair)));
+    })
+    .each<Axq::ParamList>([out](const Axq::ParamList & list) {
+        out->append(QString("%1,%2").arg(Axq::get<0, QString>(list)).arg(Axq::get<1, int>(list)));
+    })
+    .own(out)
+    .onCompleted([this, out]() {
+        QStringList sorted = out->filter(":");
+        sorted << out->filter(",");
+        print(sorted.join(' '), "\n");
+        appendTest(sorted.join(' '));
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_tupleIndex() {
+    STREAM_START_MEM;
+    expectTest("1,2,4");
+    using Sieved = std::tuple<bool, ulong>;
+    auto bits = new std::vector<bool>{true, false, false, true, false};
+    Axq::iterator<bool>(bits->begin(), bits->end())
+    .own(bits)
+    .meta<bool, Axq::Stream::Index>()
+    .filter<Sieved>([](const Sieved & sieved) {
+        return !std::get<0>(sieved);
+    })
+    .scan<QStringList, Sieved>(QStringList(), [](QStringList & acc, const Sieved & sieved) {
+        acc.append(QString::number(std::get<1>(sieved)));
+    })
+    .onCompleted<QStringList>([this](const QStringList & indices) {
+        print(indices.join(','), "\n");
+        appendTest(indices.join(','));
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_stats() {
+    STREAM_START_MEM;
+    expectTest("stages:3 in:0,10,5 out:10,5,5 callbacks:10,5 all:1");
+    auto stream = Axq::range(0, 10)
+    .filter<int>([](int v) {
+        return v % 2 == 0;
+    })
+    .each<int>([](int) {})
+    .enableStats();
+    stream.onCompleted([this, stream]() {
+        const auto stats = stream.stats();
+        QStringList in, out, callbacks;
+        for(const auto& s : stats) {
+            const auto map = s.toMap();
+            in << map.value("in").toString();
+            out << map.value("out").toString();
+            if(map.value("callbacks").toULongLong() > 0) {
+                callbacks << map.value("callbacks").toString();
+            }
+        }
+        int all = 0;
+        for(const auto& s : Axq::allStats()) {
+            all += s.toMap().value("id") == stats.last().toMap().value("id");
+        }
+        const auto result = QString("stages:%1 in:%2 out:%3 callbacks:%4 all:%5").arg(stats.size())
+                            .arg(in.join(',')).arg(out.join(',')).arg(callbacks.join(',')).arg(all);
+        print(result, "\n");
+        appendTest(result);
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_trace() {
+    STREAM_START_MEM;
+    expectTest("refused:1 callback:1 tick:1 complete:1 balanced:1");
+    auto file = new QTemporaryFile(this);
+    file->open();
+    Axq::startTrace();
+    Axq::range(0, 5)
+    .delay(10)
+    .each<int>([](int) {})
+    .onCompleted([this, file]() {
+        const auto refused = !Axq::writeTrace(file->fileName());
+        Axq::stopTrace();
+        Axq::writeTrace(file->fileName());
+        const auto json = file->readAll();
+        const auto begins = json.count("\"ph\":\"B\"");
+        const auto ends = json.count("\"ph\":\"E\"");
+        const auto result = QString("refused:%1 callback:%2 tick:%3 complete:%4 balanced:%5")
+                            .arg(refused).arg(json.contains("\"callback\"")).arg(json.contains("\"tick\""))
+                            .arg(json.contains("\"complete\"")).arg(begins > 0 && begins == ends);
+        print(result, "\n");
+        appendTest(result);
+        verifyTest();
+        delete file;
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_graph() {
+    STREAM_START_MEM;
+    expectTest("tree:1 types:1 dot:1 json:1");
+    auto stream = Axq::range(0, 5)
+    .filter<int>([](int v) {
+        return v % 2 == 0;
+    })
+    .each<int>([](int) {});
+    stream.onCompleted([this, stream]() {
+        const auto graph = stream.graph();
+        const auto nodes = graph.value("nodes").toList();
+        const auto edges = graph.value("edges").toList();
+        QStringList types;
+        for(const auto& n : nodes) {
+            types << n.toMap().value("type").toString();
+        }
+        const auto root = graph.value("root").toString();
+        const auto dot = Axq::dumpGraph();
+        const auto json = QJsonDocument::fromJson(Axq::dumpGraph(Axq::GraphFormat::Json)).toVariant().toList();
+        int found = 0;
+        for(const auto& g : json) {
+            found += g.toMap().value("root").toString() == root;
+        }
+        const auto result = QString("tree:%1 types:%2 dot:%3 json:%4")
+                            .arg(nodes.size() >= 3 && edges.size() == nodes.size() - 1)
+                            .arg(types.contains("Filter"))
+                            .arg(dot.startsWith("digraph") && dot.contains(root.toUtf8()) && dot.contains("->"))
+                            .arg(found);
+        print(result, "\n");
+        appendTest(result);
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_accounting() {
+    STREAM_START_MEM;
+    expectTest("enabled:1 created:1 live:1 sampled:1");
+    Axq::setAccounting(true, 1);
+    Axq::range(0, 5)
+    .filter<int>([](int v) {
+        return v % 2 == 0;
+    })
+    .each<int>([](int) {})
+    .onCompleted([this]() {
+        const auto report = Axq::accountingReport();
+        const auto filter = report.value("classes").toMap().value("Axq::Filter").toMap();
+        bool sampled = false;
+        for(const auto& s : report.value("samples").toList()) {
+            sampled |= s.toMap().value("type") == "Axq::Filter";
+        }
+        Axq::setAccounting(false, 0);
+        const auto result = QString("enabled:%1 created:%2 live:%3 sampled:%4")
+                            .arg(report.value("enabled").toBool())
+                            .arg(filter.value("created").toULongLong() >= 1)
+                            .arg(filter.value("live").toLongLong() >= 1)
+                            .arg(sampled);
+        print(result, "\n");
+        appendTest(result);
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
+
+void UnitTest::test_latency() {
+    STREAM_START_MEM;
+    expectTest("mid:10 end:10 delayed:1 staged:1 stats:1 dump:1");
+    auto queue = new Axq::Queue();
+    auto stream = Axq::create(queue)
+                  .measureLatency("test_mid")
+                  .delay(5)
+                  .each<int>([](int) {})
+                  .measureLatency("test_end");
+    stream.onCompleted([this, stream]() {
+        const auto latency = Axq::latencyStats();
+        const auto mid = latency.value("test_mid").toMap().value("endToEnd").toMap();
+        const auto end = latency.value("test_end").toMap();
+        const auto probe = stream.stats().last().toMap().value("latency").toMap();
+        const auto result = QString("mid:%1 end:%2 delayed:%3 staged:%4 stats:%5 dump:%6")
+                            .arg(mid.value("count").toULongLong())
+                            .arg(end.value("endToEnd").toMap().value("count").toULongLong())
+                            .arg(end.value("endToEnd").toMap().value("p50Us").toDouble() >= 5000.0)
+                            .arg(end.value("stage").toMap().value("p99Us").toDouble() >= 5000.0)
+                            .arg(probe.value("name") == "test_end")
+                            .arg(Axq::dumpLatency().contains("test_end end-to-end count 10"));
+        print(result, "\n");
+        appendTest(result);
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+    QTimer::singleShot(0, queue, [queue]() {
+        for(int i = 0; i < 10; i++) {
+            queue->push(i);
+        }
+        queue->complete();
+    });
+}
+
+void UnitTest::test_pool() {
+    STREAM_START_MEM;
+    const auto pooled = Axq::poolStats().value("enabled").toBool();
+    expectTest(QString("completed:500 pool:%1").arg(pooled ? "reused" : "off"));
+    constexpr int Rounds = 5;
+    constexpr int Pipelines = 100;
+    auto completed = std::make_shared<int>(0);
+    auto chunks = std::make_shared<QList<qulonglong>>();
+    for(int r = 0; r < Rounds; r++) {   //previous round is deleted when next starts, its nodes are reused
+        QTimer::singleShot(r * 200, this, [this, completed, chunks, pooled]() {
+            chunks->append(Axq::poolStats().value("chunks").toULongLong());
+            for(int i = 0; i < Pipelines; i++) {
+                Axq::range(0, 1)
+                .map<int, int>([](int v) {
+                    return v + 1;
+                })
+                .onCompleted([this, completed, chunks, pooled]() {
+                    if(++*completed < Rounds * Pipelines) {
+                        return;
+                    }
+                    const auto grown = Axq::poolStats().value("chunks").toULongLong() - chunks->at(1);
+                    const auto result = QString("completed:%1 pool:%2").arg(*completed)
+                                        .arg(!pooled ? "off" : grown == 0 ? "reused" : "grown");
+                    print(result, "\n");
+                    appendTest(result);
+                    verifyTest();
+                    STREAM_CHECK_MEM;
+                    next();
+                });
+            }
+        });
+    }
+}
+
+void UnitTest::test_callable() {
+    STREAM_START_MEM;
+    expectTest("small:6 moved:7 empty:1 large:201 scan:12");
+    struct Owning { //move only
+        std::unique_ptr<int> owned;
+        int operator()(int v) const {
+            return *owned + v;
+        }
+    };
+    Axq::Callable<int(int)> small(Owning{std::unique_ptr<int>(new int(5))});
+    const auto smallResult = small(1);
+    auto moved = std::move(small);
+    const auto movedResult = moved(2);
+    const bool empty = small == nullptr;
+    std::array<int, 64> table; //does not fit inline
+    table.fill(100);
+    Axq::Callable<int(int), 16> large([table](int v) {
+        return table[0] + table[63] + v;
+    });
+    const auto largeResult = large(1);
+    Axq::range(1, 5)
+    .filter<int>([](int v) {
+        return v % 2 == 0;
+    })
+    .map<int, int>([](int v) {
+        return v * 2;
+    })
+    .scan<int, int>(0, [](int& acc, int v) {
+        acc += v;
+    })
+    .onCompleted<int>([this, smallResult, movedResult, empty, largeResult](int scan) {
+        const auto result = QString("small:%1 moved:%2 empty:%3 large:%4 scan:%5")
+                            .arg(smallResult).arg(movedResult).arg(empty).arg(largeResult).arg(scan);
+        print(result, "\n");
+        appendTest(result);
+        verifyTest();
+        STREAM_CHECK_MEM;
+        next();
+    });
+}
@@ -106,6 +106,31 @@ public slots:
     void test_wait();
     void test_cancel();
     void test_complete();
+    void test_throttle();
+    void test_take();
+    void test_readMapped();
+    void test_lines();
+    void test_asyncRead();
+    void test_writeTo();
+    void test_onBufferCompleted();
+    void test_localSocket();
+    void test_codec();
+    void test_spill();
+    void test_spillError();
+    void test_journal();
+    void test_blocks();
+    void test_rangeTypes();
+    void test_fromMove();
+    void test_converter();
+    void test_tuple();
+    void test_tupleIndex();
+    void test_stats();
+    void test_trace();
+    void test_graph();
+    void test_accounting();
+    void test_latency();
+    void test_pool();
+    void test_callable();
 private:
     const int m_testCount;
     int m_currentTest = 0;